@@ -0,0 +1,79 @@
+/*!
+ * @file arena.cpp
+ *
+ * @brief Arena class source file
+ */
+
+#include <algorithm>
+
+#include "arena.hpp"
+
+namespace rala {
+
+constexpr uint64_t Arena::kSlabSize;
+constexpr uint64_t Arena::kMaxBlockSize;
+
+uint32_t sizeClass(uint64_t num_bytes) {
+    uint32_t size_class = 0;
+    while ((8ULL << size_class) < num_bytes) {
+        ++size_class;
+    }
+    return size_class;
+}
+
+Arena::Arena()
+        : slabs_(), position_(nullptr), end_(nullptr), free_lists_() {
+}
+
+Arena::~Arena() {
+}
+
+void* Arena::allocate(uint64_t num_bytes) {
+
+    if (num_bytes > kMaxBlockSize) {
+        return ::operator new(num_bytes);
+    }
+
+    uint32_t size_class = sizeClass(num_bytes);
+    if (free_lists_[size_class] != nullptr) {
+        auto block = free_lists_[size_class];
+        free_lists_[size_class] = block->next;
+        return block;
+    }
+
+    uint64_t block_size = 8ULL << size_class;
+    uint64_t alignment = std::min<uint64_t>(block_size, alignof(max_align_t));
+
+    uint64_t padding = (alignment - reinterpret_cast<uintptr_t>(position_) %
+        alignment) % alignment;
+    if (position_ == nullptr ||
+        static_cast<uint64_t>(end_ - position_) < padding + block_size) {
+
+        slabs_.emplace_back(new char[kSlabSize]);
+        position_ = slabs_.back().get();
+        end_ = position_ + kSlabSize;
+        padding = 0;
+    }
+
+    void* block = position_ + padding;
+    position_ += padding + block_size;
+    return block;
+}
+
+void Arena::deallocate(void* ptr, uint64_t num_bytes) {
+
+    if (ptr == nullptr) {
+        return;
+    }
+    if (num_bytes > kMaxBlockSize) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    auto block = static_cast<FreeBlock*>(ptr);
+    uint32_t size_class = sizeClass(num_bytes);
+    block->next = free_lists_[size_class];
+    free_lists_[size_class] = block;
+}
+
+}
@@ -0,0 +1,97 @@
+/*!
+ * @file arena.hpp
+ *
+ * @brief Arena class header file
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace rala {
+
+/*!
+ * @brief Slab allocator; blocks are rounded up to a power of two and cut from
+ * large slabs with a bump pointer, freed blocks are kept in per size free
+ * lists and recycled, and slabs are returned to the system only when the
+ * arena is destroyed (blocks larger than kMaxBlockSize bypass the arena);
+ * not thread safe
+ */
+class Arena {
+public:
+    Arena();
+    ~Arena();
+
+    void* allocate(uint64_t num_bytes);
+    void deallocate(void* ptr, uint64_t num_bytes);
+
+private:
+    Arena(const Arena&) = delete;
+    const Arena& operator=(const Arena&) = delete;
+
+    static constexpr uint64_t kSlabSize = 4 * 1024 * 1024;
+    static constexpr uint64_t kMaxBlockSize = 64 * 1024;
+    static constexpr uint32_t kNumSizeClasses = 14; // 8B to 64kB
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    std::vector<std::unique_ptr<char[]>> slabs_;
+    char* position_;
+    char* end_;
+    FreeBlock* free_lists_[kNumSizeClasses];
+};
+
+/*!
+ * @brief Standard allocator adaptor for containers whose storage should be
+ * taken from an Arena
+ */
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit ArenaAllocator(Arena* arena)
+            : arena_(arena) {
+    }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+            : arena_(other.arena()) {
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        arena_->deallocate(ptr, n * sizeof(T));
+    }
+
+    Arena* arena() const {
+        return arena_;
+    }
+
+private:
+    Arena* arena_;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return a.arena() == b.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return a.arena() != b.arena();
+}
+
+}
@@ -0,0 +1,299 @@
+/*!
+ * @file coverage.cpp
+ *
+ * @brief Coverage class source file
+ */
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RALA_X86_KERNELS
+#endif
+
+#include "coverage.hpp"
+
+namespace rala {
+
+constexpr uint8_t Coverage::kSaturated;
+
+using MaxKernel = void(*)(uint8_t* dst, const uint8_t* src, uint32_t length,
+    bool is_reversed);
+
+/*!
+ * @brief Sets dst[i] to max(dst[i], src[i]) for i in [0, length>, or to
+ * max(dst[i], src[length - 1 - i]) if is_reversed
+ */
+void maxScalar(uint8_t* dst, const uint8_t* src, uint32_t length,
+    bool is_reversed) {
+
+    if (is_reversed) {
+        for (uint32_t i = 0; i < length; ++i) {
+            dst[i] = std::max(dst[i], src[length - 1 - i]);
+        }
+    } else {
+        for (uint32_t i = 0; i < length; ++i) {
+            dst[i] = std::max(dst[i], src[i]);
+        }
+    }
+}
+
+#ifdef RALA_X86_KERNELS
+
+__attribute__((target("sse4.1")))
+void maxSse41(uint8_t* dst, const uint8_t* src, uint32_t length,
+    bool is_reversed) {
+
+    uint32_t i = 0;
+    if (is_reversed) {
+        const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+            7, 6, 5, 4, 3, 2, 1, 0);
+        for (; i + 16 <= length; i += 16) {
+            __m128i other = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                src + length - i - 16));
+            __m128i data = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_max_epu8(
+                data, _mm_shuffle_epi8(other, reverse)));
+        }
+        for (; i < length; ++i) {
+            dst[i] = std::max(dst[i], src[length - 1 - i]);
+        }
+    } else {
+        for (; i + 16 <= length; i += 16) {
+            __m128i other = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                src + i));
+            __m128i data = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_max_epu8(
+                data, other));
+        }
+        maxScalar(dst + i, src + i, length - i, false);
+    }
+}
+
+__attribute__((target("avx2")))
+void maxAvx2(uint8_t* dst, const uint8_t* src, uint32_t length,
+    bool is_reversed) {
+
+    uint32_t i = 0;
+    if (is_reversed) {
+        // bytes are reversed within each 128-bit lane, then lanes are swapped
+        const __m256i reverse = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+            7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4,
+            3, 2, 1, 0);
+        for (; i + 32 <= length; i += 32) {
+            __m256i other = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+                src + length - i - 32));
+            other = _mm256_shuffle_epi8(other, reverse);
+            other = _mm256_permute2x128_si256(other, other, 1);
+            __m256i data = _mm256_loadu_si256(reinterpret_cast<__m256i*>(
+                dst + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                _mm256_max_epu8(data, other));
+        }
+        for (; i < length; ++i) {
+            dst[i] = std::max(dst[i], src[length - 1 - i]);
+        }
+    } else {
+        for (; i + 32 <= length; i += 32) {
+            __m256i other = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+                src + i));
+            __m256i data = _mm256_loadu_si256(reinterpret_cast<__m256i*>(
+                dst + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                _mm256_max_epu8(data, other));
+        }
+        maxScalar(dst + i, src + i, length - i, false);
+    }
+}
+
+#endif
+
+MaxKernel selectMaxKernel() {
+#ifdef RALA_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return maxAvx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return maxSse41;
+    }
+#endif
+    return maxScalar;
+}
+
+uint16_t histogramSelect(const std::vector<uint64_t>& histogram, uint64_t n) {
+
+    for (uint32_t i = 0; i < histogram.size(); ++i) {
+        if (n < histogram[i]) {
+            return i;
+        }
+        n -= histogram[i];
+    }
+    return histogram.empty() ? 0 : histogram.size() - 1;
+}
+
+void Coverage::Reader::seek(uint32_t i) {
+
+    const auto& runs = coverage_.runs_;
+    auto run_end = [&] (uint32_t j) -> uint32_t {
+        return j + 1 < runs.size() ? runs[j + 1].first : coverage_.size_;
+    };
+
+    // neighbouring segments are checked before a binary search
+    if (run_ + 1 < runs.size() && i >= runs[run_ + 1].first &&
+        i < run_end(run_ + 1)) {
+        ++run_;
+    } else if (run_ > 0 && i >= runs[run_ - 1].first && i < run_begin_) {
+        --run_;
+    } else {
+        run_ = coverage_.find_run(i);
+    }
+
+    run_begin_ = runs[run_].first;
+    run_end_ = run_end(run_);
+    value_ = runs[run_].second;
+}
+
+Coverage::Coverage()
+        : size_(0), is_compressed_(false), data_(), overflow_(), runs_() {
+}
+
+Coverage::Coverage(uint32_t size, bool is_compressed)
+        : size_(size), is_compressed_(is_compressed), data_(), overflow_(),
+        runs_() {
+
+    if (is_compressed_) {
+        runs_.emplace_back(0, 0);
+    } else {
+        data_.resize(size_, 0);
+    }
+}
+
+uint16_t Coverage::overflow(uint32_t i) const {
+    return overflow_.at(i);
+}
+
+void Coverage::set_overflow(uint32_t i, uint16_t value) {
+    if (value < kSaturated) {
+        overflow_.erase(i);
+        data_[i] = value;
+    } else {
+        overflow_[i] = value;
+        data_[i] = kSaturated;
+    }
+}
+
+void Coverage::merge_max(uint32_t begin, const Coverage& other,
+    uint32_t other_begin, uint32_t length, bool is_reversed) {
+
+    static const MaxKernel max_kernel = selectMaxKernel();
+
+    // saturated values of other are merged first so that the kernel leaves
+    // them (and the overflow table) untouched
+    if (!other.overflow_.empty()) {
+        for (uint32_t i = 0; i < length; ++i) {
+            uint32_t j = is_reversed ? other_begin + length - 1 - i :
+                other_begin + i;
+            if (other.data_[j] == kSaturated) {
+                set(begin + i, std::max((*this)[begin + i], other.overflow(j)));
+            }
+        }
+    }
+
+    max_kernel(&data_[begin], &other.data_[other_begin], length, is_reversed);
+}
+
+uint32_t Coverage::find_run(uint32_t i) const {
+    return std::upper_bound(runs_.begin(), runs_.end(), i,
+        [] (uint32_t position, const std::pair<uint32_t, uint16_t>& run) {
+            return position < run.first;
+        }) - runs_.begin() - 1;
+}
+
+void Coverage::fill(uint32_t begin, uint32_t end, uint16_t value) {
+
+    if (begin >= end) {
+        return;
+    }
+
+    if (is_compressed_) {
+        assign(begin, end, Segments(1, std::make_pair(begin, value)));
+        return;
+    }
+
+    for (uint32_t i = begin; i < end; ++i) {
+        set(i, value);
+    }
+}
+
+void Coverage::segments(uint32_t begin, uint32_t end, Segments& dst) const {
+
+    dst.clear();
+    if (begin >= end) {
+        return;
+    }
+
+    if (is_compressed_) {
+        uint32_t i = find_run(begin);
+        dst.emplace_back(begin, runs_[i].second);
+        for (++i; i < runs_.size() && runs_[i].first < end; ++i) {
+            dst.emplace_back(runs_[i]);
+        }
+        return;
+    }
+
+    dst.emplace_back(begin, (*this)[begin]);
+    for (uint32_t i = begin + 1; i < end; ++i) {
+        uint16_t value = (*this)[i];
+        if (value != dst.back().second) {
+            dst.emplace_back(i, value);
+        }
+    }
+}
+
+void Coverage::assign(uint32_t begin, uint32_t end, const Segments& src) {
+
+    if (begin >= end || src.empty()) {
+        return;
+    }
+
+    if (!is_compressed_) {
+        for (uint32_t i = 0; i < src.size(); ++i) {
+            uint32_t segment_end = i + 1 < src.size() ? src[i + 1].first : end;
+            for (uint32_t j = src[i].first; j < segment_end; ++j) {
+                set(j, src[i].second);
+            }
+        }
+        return;
+    }
+
+    Segments runs;
+    runs.reserve(src.size() + 1);
+    for (const auto& it: src) {
+        if (runs.empty() || runs.back().second != it.second) {
+            runs.emplace_back(it);
+        }
+    }
+    if (end < size_) {
+        uint16_t value = (*this)[end];
+        if (runs.back().second != value) {
+            runs.emplace_back(end, value);
+        }
+    }
+
+    // replace runs starting in [begin, end] and merge equal neighbours
+    auto first = std::lower_bound(runs_.begin(), runs_.end(),
+        std::make_pair(begin, static_cast<uint16_t>(0)));
+    auto last = std::upper_bound(first, runs_.end(),
+        std::make_pair(end, static_cast<uint16_t>(UINT16_MAX)));
+
+    uint32_t i = first - runs_.begin();
+    if (i > 0 && runs_[i - 1].second == runs.front().second) {
+        runs.erase(runs.begin());
+    }
+
+    first = runs_.erase(first, last);
+    runs_.insert(first, runs.begin(), runs.end());
+}
+
+}
@@ -0,0 +1,166 @@
+/*!
+ * @file coverage.hpp
+ *
+ * @brief Coverage class header file
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rala {
+
+/*!
+ * @brief Returns the n-th smallest value (counting from zero) of a multiset
+ * given as a histogram of value counts (or the largest value if n is out of
+ * range)
+ */
+uint16_t histogramSelect(const std::vector<uint64_t>& histogram, uint64_t n);
+
+/*!
+ * @brief Per base coverage stored either in one byte per base (values which
+ * do not fit are saturated to kSaturated and kept in a sparse overflow table)
+ * or, if compressed, as run-length segments of equal coverage
+ */
+class Coverage {
+public:
+
+    /*!
+     * @brief Piecewise constant coverage; each pair holds the first position
+     * of a segment and its value, the segment ends where the next one begins
+     */
+    using Segments = std::vector<std::pair<uint32_t, uint16_t>>;
+
+    /*!
+     * @brief Cursor for (mostly) sequential reads which remembers the last
+     * visited segment of compressed coverage
+     */
+    class Reader {
+    public:
+
+        explicit Reader(const Coverage& coverage)
+                : coverage_(coverage), run_(0), run_begin_(0), run_end_(0),
+                value_(0) {
+        }
+
+        uint16_t operator[](uint32_t i) {
+            if (!coverage_.is_compressed_) {
+                return coverage_[i];
+            }
+            if (i < run_begin_ || i >= run_end_) {
+                seek(i);
+            }
+            return value_;
+        }
+
+    private:
+
+        void seek(uint32_t i);
+
+        const Coverage& coverage_;
+        uint32_t run_;
+        uint32_t run_begin_;
+        uint32_t run_end_;
+        uint16_t value_;
+    };
+
+    Coverage();
+
+    explicit Coverage(uint32_t size, bool is_compressed = false);
+
+    uint32_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    bool is_compressed() const {
+        return is_compressed_;
+    }
+
+    uint16_t operator[](uint32_t i) const {
+        if (is_compressed_) {
+            return runs_[find_run(i)].second;
+        }
+        return data_[i] != kSaturated ? data_[i] : overflow(i);
+    }
+
+    /*!
+     * @brief Stores value at position i (into the overflow table if it is
+     * greater or equal to kSaturated); slow for compressed coverage, use
+     * assign() instead
+     */
+    void set(uint32_t i, uint16_t value) {
+        if (is_compressed_) {
+            fill(i, i + 1, value);
+        } else if (value < kSaturated && data_[i] != kSaturated) {
+            data_[i] = value;
+        } else {
+            set_overflow(i, value);
+        }
+    }
+
+    /*!
+     * @brief Sets all values in the interval [begin, end> to value
+     */
+    void fill(uint32_t begin, uint32_t end, uint16_t value);
+
+    /*!
+     * @brief Stores values of the interval [begin, end> into dst as segments
+     * (first segment starts at begin, adjacent segments differ in value)
+     */
+    void segments(uint32_t begin, uint32_t end, Segments& dst) const;
+
+    /*!
+     * @brief Replaces values of the interval [begin, end> with segments src
+     * (first segment has to start at begin)
+     */
+    void assign(uint32_t begin, uint32_t end, const Segments& src);
+
+    /*!
+     * @brief Raises values of the interval [begin, begin + length> to values
+     * of the interval [other_begin, other_begin + length> of other (read
+     * backwards if is_reversed) where they are greater; both coverages have
+     * to be uncompressed (bytes are merged with SSE4.1/AVX2 kernels if the
+     * CPU supports them)
+     */
+    void merge_max(uint32_t begin, const Coverage& other, uint32_t other_begin,
+        uint32_t length, bool is_reversed);
+
+    void swap(Coverage& other) {
+        std::swap(size_, other.size_);
+        std::swap(is_compressed_, other.is_compressed_);
+        data_.swap(other.data_);
+        overflow_.swap(other.overflow_);
+        runs_.swap(other.runs_);
+    }
+
+    /*!
+     * @brief Returns the number of positions kept in the overflow table
+     */
+    uint32_t num_overflows() const {
+        return overflow_.size();
+    }
+
+    static constexpr uint8_t kSaturated = UINT8_MAX;
+
+private:
+
+    uint16_t overflow(uint32_t i) const;
+    void set_overflow(uint32_t i, uint16_t value);
+
+    uint32_t find_run(uint32_t i) const;
+
+    uint32_t size_;
+    bool is_compressed_;
+    std::vector<uint8_t> data_;
+    std::unordered_map<uint32_t, uint16_t> overflow_;
+    Segments runs_;
+};
+
+}
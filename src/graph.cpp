@@ -4,15 +4,25 @@
  * @brief Graph class source file
  */
 
+#include <sys/stat.h>
+#include <atomic>
+#include <condition_variable>
 #include <deque>
+#include <mutex>
+#include <thread>
 #include <algorithm>
 #include <iostream>
 #include <fstream>
-#include <sstream>
-#include <iterator>
 
+#include "arena.hpp"
 #include "sequence.hpp"
+#include "sequence_index.hpp"
 #include "overlap.hpp"
+#include "overlap_store.hpp"
+#include "input_file.hpp"
+#include "output_file.hpp"
+#include "mapped_file.hpp"
+#include "paf_reader.hpp"
 #include "pile.hpp"
 #include "timer.hpp"
 #include "graph.hpp"
@@ -23,12 +33,95 @@
 namespace rala {
 
 constexpr uint32_t kChunkSize = 1024 * 1024 * 1024; // ~1GB
+// overlaps are streamed in smaller chunks as up to three are alive at once
+constexpr uint32_t kStreamChunkSize = kChunkSize / 2;
+constexpr uint32_t kMaxQueuedChunks = 1;
+// bubble sources searched in parallel before the found bubbles are popped
+constexpr uint32_t kBubbleBatchSize = 4096;
+// node bases decoded at once when sequences are written out
+constexpr uint32_t kWriteChunkSize = 1024 * 1024;
+// bytes hashed from both ends of a file into its signature
+constexpr uint32_t kSignatureSampleSize = 4096;
 
 bool comparable(double a, double b, double eps) {
     return (a >= b * (1 - eps) && a <= b * (1 + eps)) ||
         (b >= a * (1 - eps) && b <= a * (1 + eps));
 }
 
+/*!
+ * @brief Hashes (FNV-1a) size, inode and modification time (in nanoseconds)
+ * of a file together with its first and last few kB, so that a file which
+ * was rewritten in place with the same size and time stamp is still told
+ * apart
+ */
+uint64_t fileSignature(const std::string& path) {
+
+    struct stat file_stat;
+    if (stat(path.c_str(), &file_stat) != 0) {
+        return 0;
+    }
+
+    uint64_t signature = 14695981039346656037ULL;
+    auto hash = [&](const void* data, uint64_t size) -> void {
+        for (uint64_t i = 0; i < size; ++i) {
+            signature ^= static_cast<const unsigned char*>(data)[i];
+            signature *= 1099511628211ULL;
+        }
+    };
+
+    uint64_t values[] = {
+        static_cast<uint64_t>(file_stat.st_size),
+        static_cast<uint64_t>(file_stat.st_ino),
+        static_cast<uint64_t>(file_stat.st_mtim.tv_sec),
+        static_cast<uint64_t>(file_stat.st_mtim.tv_nsec)
+    };
+    hash(values, sizeof(values));
+
+    FILE* input = fopen(path.c_str(), "rb");
+    if (input == nullptr) {
+        return signature;
+    }
+    std::vector<char> buffer(kSignatureSampleSize);
+    hash(buffer.data(), fread(buffer.data(), 1, buffer.size(), input));
+    if (file_stat.st_size > kSignatureSampleSize &&
+        fseeko(input, std::max<off_t>(file_stat.st_size - kSignatureSampleSize,
+            kSignatureSampleSize), SEEK_SET) == 0) {
+        hash(buffer.data(), fread(buffer.data(), 1, buffer.size(), input));
+    }
+    fclose(input);
+
+    return signature;
+}
+
+void appendNumber(std::string& dst, uint64_t value) {
+    char buffer[20];
+    uint32_t i = sizeof(buffer);
+    do {
+        buffer[--i] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    dst.append(buffer + i, sizeof(buffer) - i);
+}
+
+void printContigStats(std::vector<uint32_t>& contig_length) {
+
+    fprintf(stderr, "[rala::Graph::extract_contigs] number of contigs = %zu\n",
+        contig_length.size());
+
+    if (contig_length.empty()) {
+        return;
+    }
+
+    std::sort(contig_length.begin(), contig_length.end());
+
+    fprintf(stderr, "[rala::Graph::extract_contigs] shortest contig length = %u\n",
+        contig_length.front());
+    fprintf(stderr, "[rala::Graph::extract_contigs] median contig length = %u\n",
+        contig_length[contig_length.size() / 2]);
+    fprintf(stderr, "[rala::Graph::extract_contigs] longest contig length = %u\n",
+        contig_length.back());
+}
+
 template<typename T>
 void shrinkToFit(std::vector<T>& src, uint64_t begin) {
 
@@ -56,13 +149,17 @@ void shrinkToFit(std::vector<T>& src, uint64_t begin) {
 
 class Graph::Node {
 public:
-    // Sequence encapsulation
+    // Sequence encapsulation (the reverse complement node shares data with
+    // its pair)
     Node(uint64_t id, uint64_t sequence_id, const std::string& name,
-        const std::string& data);
+        const std::shared_ptr<PackedSequence>& data, Arena* arena);
     // Unitig
-    Node(uint64_t id, Node* begin_node, Node* end_node);
+    Node(uint64_t id, uint64_t begin_node, uint64_t end_node,
+        const Graph& graph);
     Node(const Node&) = delete;
     const Node& operator=(const Node&) = delete;
+    Node(Node&&) = default;
+    Node& operator=(Node&&) = default;
 
     ~Node();
 
@@ -70,16 +167,40 @@ public:
         return id_ & 1;
     }
 
+    uint64_t pair() const {
+        return id_ ^ 1;
+    }
+
     uint32_t length() const {
-        return data_.size();
+        return length_;
     }
 
+    /*!
+     * @brief Appends bases [begin, begin + length> of this node to dst
+     */
+    void decode(uint32_t begin, uint32_t length, std::string& dst) const;
+
+    /*!
+     * @brief Materializes the sequence of this node (unitigs are spelled
+     * from their reads only on request)
+     */
+    std::string data() const;
+    PackedSequence packed_data() const;
+
+    /*!
+     * @brief Writes bases of this node to dst, decoded in chunks into buffer
+     * so that the sequence is never held in memory as a whole; lines are
+     * wrapped at line_width bases (0 disables wrapping) and no line break
+     * follows the last base
+     */
+    void write(uint32_t line_width, std::string& buffer, OutputFile* dst) const;
+
     uint32_t indegree() const {
-        return prefix_edges_.size();
+        return indegree_;
     }
 
     uint32_t outdegree() const {
-        return suffix_edges_.size();
+        return outdegree_;
     }
 
     bool is_junction() const {
@@ -90,102 +211,292 @@ public:
         return outdegree() > 0 && indegree() == 0 && sequence_ids_.size() < 6;
     }
 
+    /*!
+     * @brief Turns the node into a tombstone and releases its data
+     */
+    void remove();
+
+    /*!
+     * @brief Bases [begin, begin + length> of a read in forward or reverse
+     * complement orientation
+     */
+    struct Segment {
+        std::shared_ptr<PackedSequence> data;
+        uint32_t begin;
+        uint32_t length;
+        bool is_reverse_complement;
+    };
+
+    /*!
+     * @brief Appends segments spelling the first length bases of node
+     */
+    void append_prefix(const Node& node, uint32_t length);
+
     uint64_t id_;
     std::string name_;
-    std::string data_;
-    std::vector<Edge*> prefix_edges_;
-    std::vector<Edge*> suffix_edges_;
-    std::vector<uint64_t> sequence_ids_;
+    uint32_t length_;
+    std::vector<Segment, ArenaAllocator<Segment>> segments_;
+    std::vector<uint64_t, ArenaAllocator<uint64_t>> sequence_ids_;
+    uint32_t indegree_;
+    uint32_t outdegree_;
     bool is_first_rc_;
     bool is_last_rc_;
     bool is_marked_;
-    Node* pair_;
+    bool is_removed_;
 };
 
 class Graph::Edge {
 public:
     // Overlap encapsulatipn
-    Edge(uint64_t id, Node* begin_node, Node* end_node, uint32_t length);
-    Edge(const Edge&) = delete;
-    const Edge& operator=(const Edge&) = delete;
+    Edge(uint64_t id, uint64_t begin_node, uint64_t end_node, uint32_t length);
 
     ~Edge();
 
-    std::string label() const {
-        return begin_node_->data_.substr(0, length_);
+    uint64_t pair() const {
+        return id_ ^ 1;
     }
 
     uint64_t id_;
-    Node* begin_node_;
-    Node* end_node_;
+    uint64_t begin_node_;
+    uint64_t end_node_;
     uint32_t length_;
-    bool is_marked_;
-    Edge* pair_;
+    bool is_removed_;
+};
+
+/*!
+ * @brief Live edges of one CSR row (tombstoned edges are skipped)
+ */
+class Graph::EdgeRange {
+public:
+
+    class Iterator {
+    public:
+        Iterator(const uint64_t* it, const uint64_t* end,
+            const std::vector<Edge>& edges)
+                : it_(it), end_(end), edges_(edges) {
+            skip_removed();
+        }
+
+        const Edge& operator*() const {
+            return edges_[*it_];
+        }
+
+        Iterator& operator++() {
+            ++it_;
+            skip_removed();
+            return *this;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return it_ != other.it_;
+        }
+
+    private:
+
+        void skip_removed() {
+            while (it_ != end_ && edges_[*it_].is_removed_) {
+                ++it_;
+            }
+        }
+
+        const uint64_t* it_;
+        const uint64_t* end_;
+        const std::vector<Edge>& edges_;
+    };
+
+    EdgeRange(const uint64_t* begin, const uint64_t* end,
+        const std::vector<Edge>& edges)
+            : begin_(begin), end_(end), edges_(edges) {
+    }
+
+    Iterator begin() const {
+        return Iterator(begin_, end_, edges_);
+    }
+
+    Iterator end() const {
+        return Iterator(end_, end_, edges_);
+    }
+
+    const Edge& front() const {
+        return *begin();
+    }
+
+private:
+    const uint64_t* begin_;
+    const uint64_t* end_;
+    const std::vector<Edge>& edges_;
 };
 
 Graph::Node::Node(uint64_t id, uint64_t sequence_id, const std::string& name,
-    const std::string& data)
-        : id_(id), name_(name), data_(data), prefix_edges_(), suffix_edges_(),
-        sequence_ids_(1, sequence_id), is_first_rc_(id & 1), is_last_rc_(id & 1),
-        is_marked_(false), pair_() {
+    const std::shared_ptr<PackedSequence>& data, Arena* arena)
+        : id_(id), name_(name), length_(data->size()),
+        segments_(1, Segment{data, 0, data->size(), (id & 1) == 1},
+            ArenaAllocator<Segment>(arena)),
+        sequence_ids_(1, sequence_id, ArenaAllocator<uint64_t>(arena)),
+        indegree_(0), outdegree_(0),
+        is_first_rc_(id & 1), is_last_rc_(id & 1), is_marked_(false),
+        is_removed_(false) {
 }
 
-Graph::Node::Node(uint64_t id, Node* begin_node, Node* end_node)
-        : id_(id), name_(), data_(), prefix_edges_(), suffix_edges_(),
-        sequence_ids_(), is_marked_(false), pair_() {
+Graph::Node::Node(uint64_t id, uint64_t begin_node, uint64_t end_node,
+    const Graph& graph)
+        : id_(id), name_(), length_(0),
+        segments_(ArenaAllocator<Segment>(graph.arena_.get())),
+        sequence_ids_(ArenaAllocator<uint64_t>(graph.arena_.get())),
+        indegree_(0), outdegree_(0), is_marked_(false), is_removed_(false) {
 
-    if (begin_node == nullptr) {
+    const auto& nodes = graph.nodes_;
+    if (begin_node >= nodes.size() || nodes[begin_node].is_removed_) {
         fprintf(stderr, "[rala::Graph::Node::Node] error: missing begin node!\n");
         exit(1);
     }
-    if (end_node == nullptr) {
+    if (end_node >= nodes.size() || nodes[end_node].is_removed_) {
         fprintf(stderr, "[rala::Graph::Node::Node] error: missing end node!\n");
         exit(1);
     }
 
-    is_first_rc_ = begin_node->is_first_rc_;
+    is_first_rc_ = nodes[begin_node].is_first_rc_;
 
     auto node = begin_node;
     while (true) {
-        auto edge = node->suffix_edges_[0];
+        const auto& edge = graph.suffix_edges(node).front();
 
-        data_ += edge->label();
+        append_prefix(nodes[node], edge.length_);
         sequence_ids_.insert(sequence_ids_.end(),
-            node->sequence_ids_.begin(),
-            node->sequence_ids_.end());
-        is_last_rc_ = node->is_last_rc_;
+            nodes[node].sequence_ids_.begin(),
+            nodes[node].sequence_ids_.end());
+        is_last_rc_ = nodes[node].is_last_rc_;
 
-        node = edge->end_node_;
+        node = edge.end_node_;
         if (node == end_node) {
             break;
         }
     }
 
     if (begin_node != end_node) {
-        data_ += end_node->data_;
+        append_prefix(nodes[end_node], nodes[end_node].length());
         sequence_ids_.insert(sequence_ids_.end(),
-            end_node->sequence_ids_.begin(),
-            end_node->sequence_ids_.end());
-        is_last_rc_ = end_node->is_last_rc_;
+            nodes[end_node].sequence_ids_.begin(),
+            nodes[end_node].sequence_ids_.end());
+        is_last_rc_ = nodes[end_node].is_last_rc_;
     }
+
+    segments_.shrink_to_fit();
 }
 
 Graph::Node::~Node() {
 }
 
-Graph::Edge::Edge(uint64_t id, Node* begin_node, Node* end_node, uint32_t length)
+void Graph::Node::remove() {
+    is_removed_ = true;
+    std::string().swap(name_);
+    segments_.clear();
+    segments_.shrink_to_fit();
+    sequence_ids_.clear();
+    sequence_ids_.shrink_to_fit();
+}
+
+void Graph::Node::append_prefix(const Node& node, uint32_t length) {
+
+    length_ += length;
+
+    for (const auto& it: node.segments_) {
+        if (length == 0) {
+            break;
+        }
+        uint32_t segment_length = std::min(length, it.length);
+        length -= segment_length;
+
+        if (!segments_.empty()) {
+            auto& last = segments_.back();
+            if (last.data == it.data &&
+                last.is_reverse_complement == it.is_reverse_complement &&
+                last.begin + last.length == it.begin) {
+
+                last.length += segment_length;
+                continue;
+            }
+        }
+        segments_.emplace_back(it);
+        segments_.back().length = segment_length;
+    }
+}
+
+void Graph::Node::decode(uint32_t begin, uint32_t length,
+    std::string& dst) const {
+
+    for (const auto& it: segments_) {
+        if (length == 0) {
+            break;
+        }
+        if (begin >= it.length) {
+            begin -= it.length;
+            continue;
+        }
+        uint32_t segment_length = std::min(length, it.length - begin);
+        it.data->decode(it.begin + begin, segment_length,
+            it.is_reverse_complement, dst);
+        length -= segment_length;
+        begin = 0;
+    }
+}
+
+std::string Graph::Node::data() const {
+    std::string dst;
+    decode(0, length_, dst);
+    return dst;
+}
+
+void Graph::Node::write(uint32_t line_width, std::string& buffer,
+    OutputFile* dst) const {
+
+    uint32_t column = 0;
+    for (uint32_t i = 0; i < length_; i += kWriteChunkSize) {
+        buffer.clear();
+        decode(i, std::min(kWriteChunkSize, length_ - i), buffer);
+        if (line_width == 0) {
+            dst->write(buffer);
+            continue;
+        }
+        for (uint32_t j = 0; j < buffer.size();) {
+            if (column == line_width) {
+                dst->write("\n", 1);
+                column = 0;
+            }
+            uint32_t length = std::min<uint32_t>(line_width - column,
+                buffer.size() - j);
+            dst->write(buffer.data() + j, length);
+            j += length;
+            column += length;
+        }
+    }
+}
+
+PackedSequence Graph::Node::packed_data() const {
+    PackedSequence dst;
+    for (const auto& it: segments_) {
+        dst.append(*it.data, it.begin, it.length, it.is_reverse_complement);
+    }
+    return dst;
+}
+
+Graph::Edge::Edge(uint64_t id, uint64_t begin_node, uint64_t end_node,
+    uint32_t length)
         : id_(id), begin_node_(begin_node), end_node_(end_node), length_(length),
-        is_marked_(false), pair_() {
+        is_removed_(false) {
 }
 
 Graph::Edge::~Edge() {
 }
 
 std::unique_ptr<Graph> createGraph(const std::string& sequences_path,
-    const std::string& overlaps_path, const std::string& mcl_out_path, int32_t mcl_group, uint32_t num_threads) {
+    const std::string& overlaps_path, const std::string& mcl_out_path, int32_t mcl_group, uint32_t num_threads,
+    uint64_t max_store_size, bool use_overlap_cache, bool compress_piles) {
 
-    std::unique_ptr<bioparser::Parser<Sequence>> sparser = nullptr;
-    std::unique_ptr<bioparser::Parser<Overlap>> oparser = nullptr;
+    std::unique_ptr<bioparser::Parser<Sequence>> (*create_sparser)(
+        const std::string&) = nullptr;
+    std::unique_ptr<bioparser::Parser<Overlap>> (*create_oparser)(
+        const std::string&) = nullptr;
 
     auto is_suffix = [](const std::string& src, const std::string& suffix) -> bool {
         if (src.size() < suffix.size()) {
@@ -196,12 +507,10 @@ std::unique_ptr<Graph> createGraph(const std::string& sequences_path,
 
     if (is_suffix(sequences_path, ".fasta") || is_suffix(sequences_path, ".fa") ||
         is_suffix(sequences_path, ".fasta.gz") || is_suffix(sequences_path, ".fa.gz")) {
-        sparser = bioparser::createParser<bioparser::FastaParser, Sequence>(
-            sequences_path);
+        create_sparser = bioparser::createParser<bioparser::FastaParser, Sequence>;
     } else if (is_suffix(sequences_path, ".fastq") || is_suffix(sequences_path, ".fq") ||
         is_suffix(sequences_path, ".fastq.gz") || is_suffix(sequences_path, ".fq.gz")) {
-        sparser = bioparser::createParser<bioparser::FastqParser, Sequence>(
-            sequences_path);
+        create_sparser = bioparser::createParser<bioparser::FastqParser, Sequence>;
     } else {
         fprintf(stderr, "[rala::createGraph] error: "
             "file %s has unsupported format extension (valid extensions: "
@@ -211,11 +520,9 @@ std::unique_ptr<Graph> createGraph(const std::string& sequences_path,
     }
 
     if (is_suffix(overlaps_path, ".mhap") || is_suffix(overlaps_path, ".mhap.gz")) {
-        oparser = bioparser::createParser<bioparser::MhapParser, Overlap>(
-            overlaps_path);
+        create_oparser = bioparser::createParser<bioparser::MhapParser, Overlap>;
     } else if (is_suffix(overlaps_path, ".paf") || is_suffix(overlaps_path, ".paf.gz")) {
-        oparser = bioparser::createParser<bioparser::PafParser, Overlap>(
-            overlaps_path);
+        create_oparser = bioparser::createParser<bioparser::PafParser, Overlap>;
     } else {
         fprintf(stderr, "[rala::createGraph] error: "
             "file %s has unsupported format extension (valid extensions: "
@@ -223,20 +530,50 @@ std::unique_ptr<Graph> createGraph(const std::string& sequences_path,
         exit(1);
     }
 
-    return std::unique_ptr<Graph>(new Graph(std::move(sparser), std::move(oparser),
-        mcl_out_path, mcl_group,
-        num_threads));
+    num_threads = std::max(num_threads, 1U);
+    auto thread_pool = thread_pool::createThreadPool(num_threads);
+
+    // gzip compressed files are decompressed outside of parsers
+    auto sequences_file = createInputFile(sequences_path, thread_pool.get(),
+        num_threads);
+    auto overlaps_file = createInputFile(overlaps_path, thread_pool.get(),
+        num_threads);
+
+    return std::unique_ptr<Graph>(new Graph(sequences_path,
+        std::move(sequences_file), create_sparser, overlaps_path,
+        std::move(overlaps_file), create_oparser, mcl_out_path, mcl_group,
+        num_threads, std::move(thread_pool), max_store_size,
+        use_overlap_cache, compress_piles));
 }
 
-Graph::Graph(std::unique_ptr<bioparser::Parser<Sequence>> sparser,
-    std::unique_ptr<bioparser::Parser<Overlap>> oparser,
+Graph::Graph(const std::string& sequences_path,
+    std::unique_ptr<InputFile> sequences_file,
+    SequenceParserCreator create_sparser,
+    const std::string& overlaps_path,
+    std::unique_ptr<InputFile> overlaps_file,
+    OverlapParserCreator create_oparser,
     const std::string& mcl_out_path,
     int32_t mcl_group,
-    uint32_t num_threads)
-        : sparser_(std::move(sparser)), name_to_id_(), piles_(),
-        coverage_median_(0), oparser_(std::move(oparser)), is_valid_overlap_(),
-        thread_pool_(thread_pool::createThreadPool(num_threads)),
-        nodes_(), edges_(), group_reads_(), filter_group(mcl_group >= 0) {
+    uint32_t num_threads,
+    std::unique_ptr<thread_pool::ThreadPool> thread_pool,
+    uint64_t max_store_size,
+    bool use_overlap_cache,
+    bool compress_piles)
+        : num_threads_(num_threads), thread_pool_(std::move(thread_pool)),
+        sequences_path_(sequences_path),
+        sequences_file_(std::move(sequences_file)),
+        create_sparser_(create_sparser), sparser_(),
+        sequence_index_(), piles_(), coverage_median_(0),
+        compress_piles_(compress_piles),
+        overlaps_path_(overlaps_path),
+        overlaps_file_(std::move(overlaps_file)),
+        create_oparser_(create_oparser), oparser_(), paf_reader_(),
+        is_valid_overlap_(), max_store_size_(max_store_size),
+        overlap_cache_path_(use_overlap_cache ? overlaps_path + ".rala" : ""),
+        overlap_store_(), arena_(new Arena()), nodes_(), edges_(), prefix_offsets_(1, 0), prefix_edge_ids_(),
+        suffix_offsets_(1, 0), suffix_edge_ids_(), num_removed_edges_(0),
+        is_marked_edge_(), marked_edges_(), group_reads_(),
+        filter_group(mcl_group >= 0) {
             if (filter_group) {
                 read_group(mcl_out_path, mcl_group);
             }
@@ -245,59 +582,201 @@ Graph::Graph(std::unique_ptr<bioparser::Parser<Sequence>> sparser,
 Graph::~Graph() {
 }
 
-void Graph::initialize() {
+void Graph::reset_sparser() {
+    sparser_.reset();
+    sequences_file_->rewind();
+    sparser_ = create_sparser_(sequences_file_->path());
+}
 
-    Timer timer;
-    timer.start();
+void Graph::reset_oparser() {
 
-    // create piles and sequence name hash
-    uint64_t num_sequences = 0;
-    sparser_->reset();
-    while (true) {
-        std::vector<std::unique_ptr<Sequence>> sequences;
-        auto status = sparser_->parse_objects(sequences, kChunkSize);
+    // uncompressed PAF files are mapped and parsed without bioparser
+    if (paf_reader_ == nullptr && overlaps_file_->is_plain() &&
+        create_oparser_ == bioparser::createParser<bioparser::PafParser,
+            Overlap>) {
+        paf_reader_ = createPafReader(overlaps_path_,
+            sequence_index_->names(), thread_pool_.get(), num_threads_);
+    }
+    if (paf_reader_ != nullptr) {
+        paf_reader_->reset();
+        return;
+    }
+
+    oparser_.reset();
+    overlaps_file_->rewind();
+    oparser_ = create_oparser_(overlaps_file_->path());
+}
 
-        for (uint64_t i = 0; i < sequences.size(); ++i, ++num_sequences) {
-            name_to_id_[sequences[i]->name()] = num_sequences;
-            piles_.emplace_back(createPile(num_sequences,
-                sequences[i]->data().size()));
+template<typename T>
+void Graph::parallel_for(uint64_t begin, uint64_t end, const T& function) {
+    parallel_for_workers(begin, end, [&](uint64_t i, uint32_t) -> void {
+        function(i);
+    });
+}
+
+template<typename T>
+void Graph::parallel_for_workers(uint64_t begin, uint64_t end,
+    const T& function) {
+
+    if (begin >= end) {
+        return;
+    }
+
+    uint64_t num_workers = std::min<uint64_t>(num_threads_, end - begin);
+    std::atomic<uint64_t> next(begin);
+
+    auto worker = [&](uint32_t worker_id) -> void {
+        uint64_t chunk_begin = next.load();
+        while (chunk_begin < end) {
+            // guided scheduling, chunks get smaller towards the end
+            uint64_t chunk_size = std::max<uint64_t>(1,
+                (end - chunk_begin) / (4 * num_workers));
+            if (!next.compare_exchange_weak(chunk_begin,
+                chunk_begin + chunk_size)) {
+                continue;
+            }
+
+            uint64_t chunk_end = std::min(end, chunk_begin + chunk_size);
+            for (uint64_t i = chunk_begin; i < chunk_end; ++i) {
+                function(i, worker_id);
+            }
+            chunk_begin = next.load();
         }
+    };
 
-        if (!status) {
-            break;
+    std::vector<std::future<void>> thread_futures;
+    for (uint64_t i = 0; i < num_workers; ++i) {
+        thread_futures.emplace_back(thread_pool_->submit_task(worker, i));
+    }
+    for (const auto& it: thread_futures) {
+        it.wait();
+    }
+}
+
+template<typename T, typename F>
+void Graph::stream_overlaps(OverlapStore* store, bool valid_only,
+    const F& consume) {
+
+    if (store != nullptr) {
+        store->reset();
+    } else {
+        reset_oparser();
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::vector<T>> chunks;
+    bool is_loaded = false;
+
+    // producer runs on its own thread as consume() occupies the calling one
+    // (tasks of paf_reader_ and consume() share thread_pool_, none of them
+    // waits for another)
+    std::thread producer([&]() -> void {
+        bool status = true;
+        while (status) {
+            std::vector<T> chunk;
+            if (store != nullptr) {
+                status = store->load(chunk, kStreamChunkSize, valid_only);
+            } else if (paf_reader_ != nullptr) {
+                status = paf_reader_->parse_objects(chunk, kStreamChunkSize);
+            } else {
+                status = oparser_->parse_objects(chunk, kStreamChunkSize);
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&]() -> bool {
+                return chunks.size() < kMaxQueuedChunks;
+            });
+            chunks.emplace_back(std::move(chunk));
+            is_loaded = !status;
+            condition.notify_all();
+        }
+    });
+
+    bool status = true;
+    while (status) {
+        std::vector<T> chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&]() -> bool {
+                return !chunks.empty();
+            });
+            chunk.swap(chunks.front());
+            chunks.pop_front();
+            status = !is_loaded || !chunks.empty();
+            condition.notify_all();
         }
+        consume(chunk, status);
+    }
+
+    producer.join();
+}
+
+void Graph::initialize() {
+
+    Timer timer;
+    timer.start();
+
+    // create piles and sequence name table (only names and lengths are read)
+    sequence_index_ = createSequenceIndex(sequences_path_,
+        sequences_file_.get(), thread_pool_.get(), num_threads_);
+    if (sequence_index_->is_from_fai()) {
+        fprintf(stderr, "[rala::Graph::initialize] using sequence index "
+            "%s.fai\n", sequences_path_.c_str());
+    }
+
+    uint64_t num_sequences = sequence_index_->size();
+    piles_.reserve(num_sequences);
+    for (uint64_t i = 0; i < num_sequences; ++i) {
+        piles_.emplace_back(createPile(i, sequence_index_->length(i),
+            compress_piles_));
     }
 
     fprintf(stderr, "[rala::Graph::initialize] loaded sequences\n");
 
+    // overlap cache is valid only for the same sequence and overlap files
+    uint64_t signature = fileSignature(sequences_path_) * 1099511628211ULL ^
+        fileSignature(overlaps_path_);
+    signature = signature * 1099511628211ULL ^ num_sequences;
+
+    overlap_store_ = createOverlapStore(max_store_size_, overlap_cache_path_,
+        signature);
+
     // update piles
     std::vector<std::unique_ptr<Overlap>> overlaps;
     uint64_t num_overlaps = 0;
 
+    // overlaps [begin, end> share a_id, only the last of the longest ones
+    // is kept for each b_id (found by sorting on (b_id, length, position))
+    std::vector<uint64_t> group;
+
     auto remove_duplicate_overlaps = [&](uint64_t begin, uint64_t end) -> void {
+        group.clear();
         for (uint64_t i = begin; i < end; ++i) {
             if (overlaps[i] == nullptr) {
                 continue;
             }
             if (overlaps[i]->a_id() == overlaps[i]->b_id()) {
                 is_valid_overlap_[num_overlaps + i] = false;
-                overlaps[i].reset();
                 continue;
             }
-            for (uint64_t j = i + 1; j < end; ++j) {
-                if (overlaps[j] == nullptr) {
-                    continue;
+            group.emplace_back(i);
+        }
+
+        std::sort(group.begin(), group.end(),
+            [&](uint64_t lhs, uint64_t rhs) -> bool {
+                if (overlaps[lhs]->b_id() != overlaps[rhs]->b_id()) {
+                    return overlaps[lhs]->b_id() < overlaps[rhs]->b_id();
                 }
-                if (overlaps[i]->b_id() != overlaps[j]->b_id()) {
-                    continue;
+                if (overlaps[lhs]->length() != overlaps[rhs]->length()) {
+                    return overlaps[lhs]->length() < overlaps[rhs]->length();
                 }
+                return lhs < rhs;
+            });
 
-                if (overlaps[i]->length() > overlaps[j]->length()) {
-                    is_valid_overlap_[num_overlaps + j] = false;
-                } else {
-                    is_valid_overlap_[num_overlaps + i] = false;
-                    break;
-                }
+        for (uint64_t i = 0; i + 1 < group.size(); ++i) {
+            if (overlaps[group[i]]->b_id() == overlaps[group[i + 1]]->b_id()) {
+                is_valid_overlap_[num_overlaps + group[i]] = false;
             }
         }
     };
@@ -306,7 +785,8 @@ void Graph::initialize() {
 
     auto store_overlap_bounds = [&](uint64_t begin, uint64_t end) -> void {
         for (uint64_t i = begin; i < end; ++i) {
-            if (overlaps[i] == nullptr) {
+            if (overlaps[i] == nullptr ||
+                overlaps[i]->a_id() == overlaps[i]->b_id()) {
                 continue;
             }
             overlap_bounds[overlaps[i]->a_id()].emplace_back(
@@ -320,82 +800,116 @@ void Graph::initialize() {
         }
     };
 
-    oparser_->reset();
-    while (true) {
-        uint64_t l = overlaps.size();
-        auto status = oparser_->parse_objects(overlaps, kChunkSize);
-
-        is_valid_overlap_.resize(is_valid_overlap_.size() + overlaps.size() - l, true);
-
-        uint64_t c = 0;
-        for (uint64_t i = l; i < overlaps.size(); ++i) {
-            if (!overlaps[i]->transmute(piles_, name_to_id_)) {
-                is_valid_overlap_[num_overlaps + i] = false;
-                overlaps[i].reset();
+    auto store_overlaps = [&](uint64_t begin, uint64_t end) -> void {
+        if (overlap_store_ == nullptr) {
+            return;
+        }
+        for (uint64_t i = begin; i < end; ++i) {
+            if (overlaps[i] == nullptr) {
                 continue;
             }
+            if (!overlap_store_->store(overlaps[i],
+                is_valid_overlap_[num_overlaps + i])) {
+
+                fprintf(stderr, "[rala::Graph::initialize] warning: "
+                    "overlap store exceeded its memory budget, "
+                    "overlaps will be parsed in each stage!\n");
+                overlap_store_.reset();
+                return;
+            }
+        }
+    };
+
+    auto update_piles = [&]() -> void {
+        parallel_for(0, piles_.size(), [&](uint64_t i) -> void {
+            piles_[i]->add_layers(overlap_bounds[i]);
+            std::vector<uint32_t>().swap(overlap_bounds[i]);
+        });
+    };
+
+    bool is_cached = overlap_store_ != nullptr && overlap_store_->is_cached();
+    if (is_cached) {
+        fprintf(stderr, "[rala::Graph::initialize] using overlap cache %s\n",
+            overlap_cache_path_.c_str());
+
+        stream_overlaps<std::unique_ptr<Overlap>>(overlap_store_.get(), false,
+            [&](std::vector<std::unique_ptr<Overlap>>& chunk, bool) -> void {
+                overlaps.swap(chunk);
+                store_overlap_bounds(0, overlaps.size());
+                overlaps.clear();
+
+                update_piles();
+            });
+    } else {
+        // overlaps are parsed here, the store is only being filled
+        auto load_overlaps = [&](std::vector<std::unique_ptr<Overlap>>& chunk,
+            bool status) -> void {
+
+            uint64_t l = overlaps.size();
+            overlaps.insert(overlaps.end(), std::make_move_iterator(chunk.begin()),
+                std::make_move_iterator(chunk.end()));
+
+            is_valid_overlap_.resize(is_valid_overlap_.size() + overlaps.size() - l, true);
+
+            uint64_t c = 0;
+            for (uint64_t i = l; i < overlaps.size(); ++i) {
+                if (!overlaps[i]->transmute(piles_, sequence_index_->names())) {
+                    is_valid_overlap_[num_overlaps + i] = false;
+                    overlaps[i].reset();
+                    continue;
+                }
 
-            while (overlaps[c] == nullptr) {
-                ++c;
+                while (overlaps[c] == nullptr) {
+                    ++c;
+                }
+                if (overlaps[c]->a_id() != overlaps[i]->a_id()) {
+                    remove_duplicate_overlaps(c, i);
+                    store_overlap_bounds(c, i);
+                    store_overlaps(c, i);
+                    c = i;
+                }
             }
-            if (overlaps[c]->a_id() != overlaps[i]->a_id()) {
-                remove_duplicate_overlaps(c, i);
-                store_overlap_bounds(c, i);
-                c = i;
+            if (!status) {
+                remove_duplicate_overlaps(c, overlaps.size());
+                store_overlap_bounds(c, overlaps.size());
+                store_overlaps(c, overlaps.size());
+                c = overlaps.size();
             }
-        }
-        if (!status) {
-            remove_duplicate_overlaps(c, overlaps.size());
-            store_overlap_bounds(c, overlaps.size());
-            c = overlaps.size();
-        }
-        num_overlaps += c;
+            num_overlaps += c;
 
-        {
-            std::vector<std::unique_ptr<Overlap>> tmp;
-            for (uint64_t i = c; i < overlaps.size(); ++i) {
-                tmp.emplace_back(std::move(overlaps[i]));
+            {
+                std::vector<std::unique_ptr<Overlap>> tmp;
+                for (uint64_t i = c; i < overlaps.size(); ++i) {
+                    tmp.emplace_back(std::move(overlaps[i]));
+                }
+                overlaps.swap(tmp);
             }
-            overlaps.swap(tmp);
-        }
 
-        std::vector<std::future<void>> thread_futures;
-        for (const auto& it: piles_) {
-            thread_futures.emplace_back(thread_pool_->submit_task(
-                [&](uint64_t i) -> void {
-                    piles_[i]->add_layers(overlap_bounds[i]);
-                    std::vector<uint32_t>().swap(overlap_bounds[i]);
-                }, it->id()));
-        }
-        for (const auto& it: thread_futures) {
-            it.wait();
-        }
+            update_piles();
+        };
 
-        if (!status) {
-            break;
-        }
+        stream_overlaps<std::unique_ptr<Overlap>>(nullptr, false, load_overlaps);
+    }
+
+    if (overlap_store_ != nullptr && !overlap_store_->finalize()) {
+        fprintf(stderr, "[rala::Graph::initialize] warning: "
+            "overlap store is incomplete, "
+            "overlaps will be parsed in each stage!\n");
+        overlap_store_.reset();
+    }
+    if (overlap_store_ != nullptr) {
+        // validity of each overlap is kept in the store
+        std::vector<bool>().swap(is_valid_overlap_);
     }
 
     fprintf(stderr, "[rala::Graph::initialize] loaded overlaps\n");
 
     // trim reads
-    std::vector<std::future<void>> thread_futures;
-    for (const auto& it: piles_) {
-        if (it == nullptr) {
-            continue;
+    parallel_for(0, piles_.size(), [&](uint64_t i) -> void {
+        if (piles_[i] != nullptr && !piles_[i]->find_valid_region()) {
+            piles_[i].reset();
         }
-
-        thread_futures.emplace_back(thread_pool_->submit_task(
-            [&](uint64_t i) -> void {
-                if (!piles_[i]->find_valid_region()) {
-                    piles_[i].reset();
-                };
-            }, it->id()));
-    }
-    for (const auto& it: thread_futures) {
-        it.wait();
-    }
-    thread_futures.clear();
+    });
 
     uint64_t num_prefiltered_sequences = 0;
     for (const auto& it: piles_) {
@@ -421,33 +935,26 @@ void Graph::preprocess() {
     timer.start();
 
     // find coverage median of the dataset
-    std::vector<std::future<void>> thread_futures;
-    for (const auto& it: piles_) {
-        if (it == nullptr) {
-            continue;
+    parallel_for(0, piles_.size(), [&](uint64_t i) -> void {
+        if (piles_[i] != nullptr) {
+            piles_[i]->find_median();
         }
+    });
 
-        thread_futures.emplace_back(thread_pool_->submit_task(
-            [&](uint32_t i) -> void {
-                piles_[i]->find_median();
-            }, it->id()));
-    }
-    for (const auto& it: thread_futures) {
-        it.wait();
-    }
-    thread_futures.clear();
-
-    std::vector<uint16_t> medians;
+    std::vector<uint64_t> medians;
+    uint64_t num_medians = 0;
     for (const auto& it: piles_) {
         if (it == nullptr) {
             continue;
         }
-        medians.emplace_back(it->median());
+        if (medians.size() <= it->median()) {
+            medians.resize(it->median() + 1, 0);
+        }
+        ++medians[it->median()];
+        ++num_medians;
     }
 
-    std::nth_element(medians.begin(), medians.begin() + medians.size() / 2,
-        medians.end());
-    coverage_median_ = medians[medians.size() / 2];
+    coverage_median_ = histogramSelect(medians, num_medians / 2);
 
     fprintf(stderr, "[rala::Graph::preprocess] dataset coverage median = %u\n",
         coverage_median_);
@@ -484,38 +991,29 @@ void Graph::preprocess() {
     }
 
     // find chimeric reads
-    for (const auto& it: piles_) {
-        if (it == nullptr) {
-            continue;
+    parallel_for(0, piles_.size(), [&](uint64_t i) -> void {
+        if (piles_[i] != nullptr &&
+            !piles_[i]->find_chimeric_regions(coverage_median_)) {
+            piles_[i].reset();
         }
-
-        thread_futures.emplace_back(thread_pool_->submit_task(
-            [&](uint32_t j) -> void {
-                if (!piles_[j]->find_chimeric_regions(coverage_median_)) {
-                    piles_[j].reset();
-                }
-            }, it->id()));
-    }
-    for (const auto& it: thread_futures) {
-        it.wait();
-    }
-    thread_futures.clear();
+    });
 
     fprintf(stderr, "[rala::Graph::preprocess] processed chimeric sequences\n");
 
-    // correct piles
-    oparser_->reset();
-    while (true) {
-        std::vector<std::vector<std::shared_ptr<Overlap>>> distributed_overlaps(piles_.size());
+    // correct piles, overlaps of each chunk are bucketed by pile with a
+    // counting sort so that each pile is corrected over a contiguous slice
+    std::vector<uint64_t> pile_offsets(piles_.size() + 1, 0);
+    std::vector<PileOverlap> pile_overlaps;
 
-        std::vector<std::shared_ptr<Overlap>> overlaps;
-        auto status = oparser_->parse_objects(overlaps, kChunkSize);
+    auto correct_piles = [&](std::vector<std::unique_ptr<Overlap>>& overlaps,
+        bool status) -> void {
 
-        for (uint64_t i = 0; i < overlaps.size(); ++i) {
+        parallel_for(0, overlaps.size(), [&](uint64_t i) -> void {
             auto& it = overlaps[i];
-            if (!it->transmute(piles_, name_to_id_) || !it->trim(piles_)) {
+            if (!it->transmute(piles_, sequence_index_->names()) ||
+                !it->trim(piles_)) {
                 it.reset();
-                continue;
+                return;
             }
 
             auto absolute_difference = [](uint32_t a, uint32_t b) -> uint32_t {
@@ -528,83 +1026,85 @@ void Graph::preprocess() {
             if (absolute_difference(it->a_end() - it->a_begin(), it->b_end() -
                 it->b_begin()) > correction_length * 0.01) {
                 it.reset();
-                continue;
             }
-
-            distributed_overlaps[it->a_id()].emplace_back(it);
-            distributed_overlaps[it->b_id()].emplace_back(it);
+        });
+
+        // pile i owns [pile_offsets[i], pile_offsets[i + 1]> once the views
+        // are scattered backwards from the inclusive prefix sums
+        std::fill(pile_offsets.begin(), pile_offsets.end(), 0);
+        for (const auto& it: overlaps) {
+            if (it != nullptr) {
+                ++pile_offsets[it->a_id()];
+                ++pile_offsets[it->b_id()];
+            }
+        }
+        for (uint64_t i = 1; i < pile_offsets.size(); ++i) {
+            pile_offsets[i] += pile_offsets[i - 1];
         }
 
-        for (const auto& it: piles_) {
+        pile_overlaps.resize(pile_offsets.back());
+        for (const auto& it: overlaps) {
             if (it == nullptr) {
                 continue;
             }
-
-            thread_futures.emplace_back(thread_pool_->submit_task(
-                [&](uint64_t i) -> void {
-                    piles_[i]->correct(distributed_overlaps[i], piles_);
-                    std::vector<std::shared_ptr<Overlap>>().swap(distributed_overlaps[i]);
-                }, it->id()));
-        }
-        for (const auto& it: thread_futures) {
-            it.wait();
-        }
-        thread_futures.clear();
+            pile_overlaps[--pile_offsets[it->a_id()]] = { it->b_id(),
+                it->a_begin(), it->a_end(), it->b_begin(), it->b_end(),
+                it->orientation() };
+            pile_overlaps[--pile_offsets[it->b_id()]] = { it->a_id(),
+                it->b_begin(), it->b_end(), it->a_begin(), it->a_end(),
+                it->orientation() };
+        }
+        overlaps.clear();
+
+        parallel_for(0, piles_.size(), [&](uint64_t i) -> void {
+            if (piles_[i] != nullptr) {
+                piles_[i]->correct(pile_overlaps, pile_offsets[i],
+                    pile_offsets[i + 1], piles_);
+            }
+        });
 
         if (!status) {
             fprintf(stderr, "[rala::Graph::preprocess] load overlaps\n");
             fprintf(stderr, "[rala::Graph::preprocess] corrected piles\n");
 
             // update coverage medians
-            for (const auto& it: piles_) {
-                if (it == nullptr) {
-                    continue;
+            parallel_for(0, piles_.size(), [&](uint64_t i) -> void {
+                if (piles_[i] != nullptr) {
+                    piles_[i]->find_median();
                 }
+            });
 
-                thread_futures.emplace_back(thread_pool_->submit_task(
-                    [&](uint64_t i) -> void {
-                        piles_[i]->find_median();
-                    }, it->id()));
-            }
-            for (const auto& it: thread_futures) {
-                it.wait();
-            }
-            thread_futures.clear();
-
-            std::vector<uint16_t> medians;
+            std::vector<uint64_t> medians;
+            uint64_t num_medians = 0;
             for (const auto& it: piles_) {
                 if (it == nullptr) {
                     continue;
                 }
-                medians.emplace_back(it->median());
+                if (medians.size() <= it->median()) {
+                    medians.resize(it->median() + 1, 0);
+                }
+                ++medians[it->median()];
+                ++num_medians;
             }
 
-            std::nth_element(medians.begin(), medians.begin() + medians.size() / 2,
-                medians.end());
-            coverage_median_ = medians[medians.size() / 2];
+            coverage_median_ = histogramSelect(medians, num_medians / 2);
 
             fprintf(stderr, "[rala::Graph::preprocess] dataset coverage median = %u\n",
                 coverage_median_);
-
-            break;
         }
-    }
+    };
+
+    stream_overlaps<std::unique_ptr<Overlap>>(overlap_store_.get(), false,
+        correct_piles);
+
+    std::vector<PileOverlap>().swap(pile_overlaps);
 
     // find repetitive regions
-    for (const auto& it: piles_) {
-        if (it == nullptr) {
-            continue;
+    parallel_for(0, piles_.size(), [&](uint64_t i) -> void {
+        if (piles_[i] != nullptr) {
+            piles_[i]->find_repetitive_regions(coverage_median_);
         }
-
-        thread_futures.emplace_back(thread_pool_->submit_task(
-            [&](uint32_t i) -> void {
-                piles_[i]->find_repetitive_regions(coverage_median_);
-            }, it->id()));
-    }
-    for (const auto& it: thread_futures) {
-        it.wait();
-    }
-    thread_futures.clear();
+    });
 
     fprintf(stderr, "[rala::Graph::preprocess] processed repetitive sequences\n");
 
@@ -632,15 +1132,18 @@ void Graph::construct(bool preprocess) {
     std::vector<std::unique_ptr<Overlap>> overlaps;
     uint64_t num_overlaps = 0;
 
-    oparser_->reset();
-    while (true) {
+    auto load_overlaps = [&](std::vector<std::unique_ptr<Overlap>>& chunk,
+        bool status) -> void {
+
         uint64_t l = overlaps.size();
-        auto status = oparser_->parse_objects(overlaps, kChunkSize);
+        overlaps.insert(overlaps.end(), std::make_move_iterator(chunk.begin()),
+            std::make_move_iterator(chunk.end()));
 
         for (uint64_t i = l; i < overlaps.size(); ++i) {
             auto& it = overlaps[i];
-            if (!is_valid_overlap_[num_overlaps + i - l] ||
-                !it->transmute(piles_, name_to_id_) ||
+            if ((overlap_store_ == nullptr &&
+                !is_valid_overlap_[num_overlaps + i - l]) ||
+                !it->transmute(piles_, sequence_index_->names()) ||
                 !it->trim(piles_)) {
 
                 it.reset();
@@ -691,32 +1194,63 @@ void Graph::construct(bool preprocess) {
                 }
             }
             shrinkToFit(overlaps, 0);
-
-            break;
         }
-    }
+    };
+
+    stream_overlaps<std::unique_ptr<Overlap>>(overlap_store_.get(), true,
+        load_overlaps);
 
     fprintf(stderr, "[rala::Graph::construct] loaded overlaps\n");
 
     // store reads
     std::vector<std::unique_ptr<Sequence>> sequences;
-
-    sparser_->reset();
-    while (true) {
-        uint64_t l = sequences.size();
-        auto status = sparser_->parse_objects(sequences, kChunkSize);
-
-        for (uint64_t i = l; i < sequences.size(); ++i) {
+    uint64_t num_sequences = sequence_index_->size();
+
+    auto sequences_file = sequence_index_->has_ranges() ?
+        createMappedFile(sequences_path_, false) : nullptr;
+    if (sequences_file != nullptr) {
+        // only reads which survived preprocessing are read, in parallel
+        sequences.resize(num_sequences);
+        parallel_for(0, num_sequences, [&](uint64_t i) -> void {
             if (piles_[i] == nullptr) {
-                sequences[i].reset();
-                continue;
+                return;
             }
+            sequences[i] = sequence_index_->load(*sequences_file, i);
             sequences[i]->trim(piles_[i]->begin(), piles_[i]->end());
-            // piles_[i].reset();
-        }
+        });
+        sequences_file.reset();
+    } else {
+        reset_sparser();
+        while (true) {
+            uint64_t l = sequences.size();
+            auto status = sparser_->parse_objects(sequences, kChunkSize);
+
+            if (sequences.size() > num_sequences || (!status &&
+                sequences.size() != num_sequences)) {
+                fprintf(stderr, "[rala::Graph::construct] error: "
+                    "sequence index does not match file %s!\n",
+                    sequences_path_.c_str());
+                exit(1);
+            }
 
-        if (!status) {
-            break;
+            for (uint64_t i = l; i < sequences.size(); ++i) {
+                if (sequences[i]->data().size() != sequence_index_->length(i)) {
+                    fprintf(stderr, "[rala::Graph::construct] error: "
+                        "sequence index does not match file %s!\n",
+                        sequences_path_.c_str());
+                    exit(1);
+                }
+                if (piles_[i] == nullptr) {
+                    sequences[i].reset();
+                    continue;
+                }
+                sequences[i]->trim(piles_[i]->begin(), piles_[i]->end());
+                // piles_[i].reset();
+            }
+
+            if (!status) {
+                break;
+            }
         }
     }
 
@@ -725,6 +1259,12 @@ void Graph::construct(bool preprocess) {
     // create assembly graph
     std::vector<int64_t> sequence_id_to_node_id(sequences.size(), -1);
     uint64_t node_id = 0;
+
+    nodes_.reserve(2 * (sequences.size() - std::count(sequences.begin(),
+        sequences.end(), nullptr)));
+    edges_.reserve(2 * (overlaps.size() - std::count(overlaps.begin(),
+        overlaps.end(), nullptr)));
+
     for (uint64_t i = 0; i < sequences.size(); ++i) {
         if (sequences[i] == nullptr) {
             continue;
@@ -733,24 +1273,27 @@ void Graph::construct(bool preprocess) {
 
         sequence_id_to_node_id[i] = node_id;
 
-        std::unique_ptr<Node> node(new Node(node_id++, i, it->name(), it->data()));
-        std::unique_ptr<Node> node_complement(new Node(node_id++, i, it->name(),
-            it->reverse_complement()));
-
-        node->pair_ = node_complement.get();
-        node_complement->pair_ = node.get();
-
-        nodes_.emplace_back(std::move(node));
-        nodes_.emplace_back(std::move(node_complement));
+        // names are taken from the index as parsers keep whole header lines
+        auto name = sequence_index_->names().name(i);
+        auto data = std::allocate_shared<PackedSequence>(
+            ArenaAllocator<PackedSequence>(arena_.get()), it->data());
+        nodes_.emplace_back(node_id++, i, name, data, arena_.get());
+        nodes_.emplace_back(node_id++, i, name, data, arena_.get());
 
         sequences[i].reset();
     }
 
-    uint64_t edge_id = 0;
+    auto add_edge = [&](uint64_t begin_node, uint64_t end_node,
+        uint32_t length) -> void {
+
+        edges_.emplace_back(edges_.size(), begin_node, end_node, length);
+        ++nodes_[begin_node].outdegree_;
+        ++nodes_[end_node].indegree_;
+    };
+
     for (auto& it: overlaps) {
-        Node* node_a = nodes_[sequence_id_to_node_id[it->a_id()]].get();
-        Node* node_b = nodes_[sequence_id_to_node_id[it->b_id()] +
-            it->orientation()].get();
+        uint64_t node_a = sequence_id_to_node_id[it->a_id()];
+        uint64_t node_b = sequence_id_to_node_id[it->b_id()] + it->orientation();
 
         uint32_t a_begin = it->a_begin();
         uint32_t a_end = it->a_end();
@@ -760,45 +1303,22 @@ void Graph::construct(bool preprocess) {
             it->b_length() - it->b_begin();
 
         if (it->type() == OverlapType::kAB) {
-            std::unique_ptr<Edge> edge(new Edge(edge_id++, node_a, node_b,
-                a_begin - b_begin));
-            std::unique_ptr<Edge> edge_complement(new Edge(edge_id++,
-                node_b->pair_, node_a->pair_, (it->b_length() - b_end) -
-                (it->a_length() - a_end)));
-
-            edge->pair_ = edge_complement.get();
-            edge_complement->pair_ = edge.get();
-
-            node_a->suffix_edges_.emplace_back(edge.get());
-            node_a->pair_->prefix_edges_.emplace_back(edge_complement.get());
-            node_b->prefix_edges_.emplace_back(edge.get());
-            node_b->pair_->suffix_edges_.emplace_back(edge_complement.get());
-
-            edges_.emplace_back(std::move(edge));
-            edges_.emplace_back(std::move(edge_complement));
+            add_edge(node_a, node_b, a_begin - b_begin);
+            add_edge(node_b ^ 1, node_a ^ 1, (it->b_length() - b_end) -
+                (it->a_length() - a_end));
 
         } else if (it->type() == OverlapType::kBA) {
-            std::unique_ptr<Edge> edge(new Edge(edge_id++, node_b, node_a,
-                b_begin - a_begin));
-            std::unique_ptr<Edge> edge_complement(new Edge(edge_id++,
-                node_a->pair_, node_b->pair_, (it->a_length() - a_end) -
-                (it->b_length() - b_end)));
-
-            edge->pair_ = edge_complement.get();
-            edge_complement->pair_ = edge.get();
-
-            node_b->suffix_edges_.emplace_back(edge.get());
-            node_b->pair_->prefix_edges_.emplace_back(edge_complement.get());
-            node_a->prefix_edges_.emplace_back(edge.get());
-            node_a->pair_->suffix_edges_.emplace_back(edge_complement.get());
-
-            edges_.emplace_back(std::move(edge));
-            edges_.emplace_back(std::move(edge_complement));
+            add_edge(node_b, node_a, b_begin - a_begin);
+            add_edge(node_a ^ 1, node_b ^ 1, (it->a_length() - a_end) -
+                (it->b_length() - b_end));
         }
 
         it.reset();
     }
 
+    is_marked_edge_.assign(edges_.size(), false);
+    compact();
+
     fprintf(stderr, "[rala::Graph::construct] number of nodes in graph = %zu\n",
         nodes_.size());
     fprintf(stderr, "[rala::Graph::construct] number of edges in graph = %zu\n",
@@ -807,12 +1327,25 @@ void Graph::construct(bool preprocess) {
     timer.print("[rala::Graph::construct] elapsed time =");
 }
 
-void Graph::simplify(const std::string& debug_prefix) {
+void Graph::simplify(const std::string& debug_prefix,
+    const std::string& gfa_prefix, bool is_gfa_sequence_separate) {
 
     Timer timer;
     timer.start();
 
+    uint32_t stage = 0;
+    auto print_stage = [&](const std::string& name) -> void {
+        if (!gfa_prefix.empty()) {
+            print_gfa(gfa_prefix + "_" + std::to_string(stage) + "_" + name +
+                ".gfa", is_gfa_sequence_separate);
+        }
+        ++stage;
+    };
+
+    print_stage("initial");
+
     uint32_t num_transitive_edges = remove_transitive_edges();
+    print_stage("transitive_edges");
 
     uint32_t num_tips = 0;
     uint32_t num_bubbles = 0;
@@ -832,6 +1365,7 @@ void Graph::simplify(const std::string& debug_prefix) {
             break;
         }
     }
+    print_stage("tips_bubbles");
 
     if (!debug_prefix.empty()) {
         print_csv(debug_prefix + "_graph.csv");
@@ -840,6 +1374,7 @@ void Graph::simplify(const std::string& debug_prefix) {
 
     // TODO: try to avoid removal of long edges!
     uint32_t num_long_edges = remove_long_edges();
+    print_stage("long_edges");
 
     while (true) {
         uint32_t num_changes = create_unitigs();
@@ -852,6 +1387,7 @@ void Graph::simplify(const std::string& debug_prefix) {
             break;
         }
     }
+    print_stage("tips");
 
     fprintf(stderr, "[rala::Graph::simplify] number of transitive edges = %u\n",
         num_transitive_edges);
@@ -893,40 +1429,54 @@ void Graph::read_group(const std::string& mcl_out_path, int32_t mcl_group) {
 
 uint32_t Graph::remove_transitive_edges() {
 
-    uint32_t num_transitive_edges = 0;
-    std::vector<Edge*> candidate_edge(nodes_.size(), nullptr);
+    // nodes are processed independently as marks are only ever added (edge
+    // pairs are marked at most once, so the outcome does not depend on the
+    // order of nodes)
+    std::atomic<uint32_t> num_transitive_edges(0);
+    std::vector<std::atomic<bool>> is_transitive(edges_.size() / 2);
+    std::vector<std::vector<const Edge*>> candidate_edges(num_threads_);
 
-    for (const auto& node_a: nodes_) {
-        if (node_a == nullptr) {
-            continue;
+    parallel_for_workers(0, nodes_.size(), [&](uint64_t a,
+        uint32_t worker_id) -> void {
+
+        if (nodes_[a].is_removed_) {
+            return;
         }
 
-        for (const auto& edge_ab: node_a->suffix_edges_) {
-            candidate_edge[edge_ab->end_node_->id_] = edge_ab;
+        auto& candidate_edge = candidate_edges[worker_id];
+        if (candidate_edge.empty()) {
+            candidate_edge.resize(nodes_.size(), nullptr);
         }
 
-        for (const auto& edge_ab: node_a->suffix_edges_) {
-            const auto& node_b = nodes_[edge_ab->end_node_->id_];
+        for (const auto& edge_ab: suffix_edges(a)) {
+            candidate_edge[edge_ab.end_node_] = &edge_ab;
+        }
 
-            for (const auto& edge_bc: node_b->suffix_edges_) {
-                uint64_t c = edge_bc->end_node_->id_;
+        for (const auto& edge_ab: suffix_edges(a)) {
+            for (const auto& edge_bc: suffix_edges(edge_ab.end_node_)) {
+                uint64_t c = edge_bc.end_node_;
 
-                if (candidate_edge[c] != nullptr && !candidate_edge[c]->is_marked_) {
-                    if (comparable(edge_ab->length_ + edge_bc->length_,
-                        candidate_edge[c]->length_, 0.12)) {
+                if (candidate_edge[c] != nullptr &&
+                    !is_transitive[candidate_edge[c]->id_ >> 1]) {
+                    if (comparable(edge_ab.length_ + edge_bc.length_,
+                        candidate_edge[c]->length_, 0.12) &&
+                        !is_transitive[candidate_edge[c]->id_ >> 1].exchange(
+                            true)) {
 
-                        candidate_edge[c]->is_marked_ = true;
-                        candidate_edge[c]->pair_->is_marked_ = true;
-                        marked_edges_.emplace(candidate_edge[c]->id_);
-                        marked_edges_.emplace(candidate_edge[c]->pair_->id_);
                         ++num_transitive_edges;
                     }
                 }
             }
         }
 
-        for (const auto& edge_ab: node_a->suffix_edges_) {
-            candidate_edge[edge_ab->end_node_->id_] = nullptr;
+        for (const auto& edge_ab: suffix_edges(a)) {
+            candidate_edge[edge_ab.end_node_] = nullptr;
+        }
+    });
+
+    for (uint64_t i = 0; i < is_transitive.size(); ++i) {
+        if (is_transitive[i]) {
+            mark_edge(i << 1);
         }
     }
 
@@ -940,23 +1490,20 @@ uint32_t Graph::remove_long_edges() {
     uint32_t num_long_edges = 0;
 
     for (const auto& node: nodes_) {
-        if (node == nullptr || node->suffix_edges_.size() < 2){
+        if (node.is_removed_ || node.outdegree() < 2){
             continue;
         }
 
-        for (const auto& edge: node->suffix_edges_) {
-            for (const auto& other_edge: node->suffix_edges_) {
-                if (edge->id_ == other_edge->id_ || edge->is_marked_ ||
-                    other_edge->is_marked_) {
+        for (const auto& edge: suffix_edges(node.id_)) {
+            for (const auto& other_edge: suffix_edges(node.id_)) {
+                if (edge.id_ == other_edge.id_ || is_marked_edge_[edge.id_] ||
+                    is_marked_edge_[other_edge.id_]) {
                     continue;
                 }
-                if (node->length() - other_edge->length_ <
-                    (node->length() - edge->length_) * 0.9) {
+                if (node.length() - other_edge.length_ <
+                    (node.length() - edge.length_) * 0.9) {
 
-                    other_edge->is_marked_ = true;
-                    other_edge->pair_->is_marked_ = true;
-                    marked_edges_.emplace(other_edge->id_);
-                    marked_edges_.emplace(other_edge->pair_->id_);
+                    mark_edge(other_edge.id_);
                     ++num_long_edges;
                 }
             }
@@ -968,48 +1515,128 @@ uint32_t Graph::remove_long_edges() {
     return num_long_edges;
 }
 
-// TODO: reimplement remove_tips
 uint32_t Graph::remove_tips() {
 
+    // edges of each tip are detached right away as later tips depend on the
+    // updated degrees, while isolated nodes are swept once per call
     uint32_t num_tip_edges = 0;
+    uint64_t num_detached_edges = 0;
 
-    for (const auto& node: nodes_) {
-        if (node == nullptr || !node->is_tip()) {
+    for (auto& node: nodes_) {
+        if (node.is_removed_ || !node.is_tip()) {
             continue;
         }
 
         uint32_t num_removed_edges = 0;
 
-        for (const auto& edge: node->suffix_edges_) {
-            if (edge->end_node_->indegree() > 1) {
-                edge->is_marked_ = true;
-                edge->pair_->is_marked_ = true;
-                marked_edges_.emplace(edge->id_);
-                marked_edges_.emplace(edge->pair_->id_);
+        for (const auto& edge: suffix_edges(node.id_)) {
+            if (nodes_[edge.end_node_].indegree() > 1) {
+                mark_edge(edge.id_);
                 ++num_removed_edges;
             }
         }
 
-        if (num_removed_edges == node->suffix_edges_.size()) {
-            node->is_marked_ = true;
-            node->pair_->is_marked_ = true;
+        if (num_removed_edges == node.outdegree()) {
+            node.is_marked_ = true;
+            nodes_[node.pair()].is_marked_ = true;
         }
 
         num_tip_edges += num_removed_edges;
 
-        remove_marked_objects(true);
+        num_detached_edges = detach_marked_edges(num_detached_edges);
     }
 
+    remove_marked_objects(true);
+
     return num_tip_edges;
 }
 
 uint32_t Graph::remove_bubbles() {
 
-    std::vector<uint32_t> distance(nodes_.size(), 0);
-    std::vector<uint64_t> visited(nodes_.size(), 0);
-    uint64_t visited_length = 0;
-    std::vector<int64_t> predecessor(nodes_.size(), -1);
-    std::deque<uint64_t> node_queue;
+    // sources are searched in parallel in batches on the current graph and
+    // bubbles are popped in the order of sources; a search which inspected a
+    // node changed by an earlier pop in the same batch is repeated, so that
+    // the outcome equals popping bubbles one source at a time
+    std::vector<std::vector<uint32_t>> distances(num_threads_);
+    std::vector<std::vector<int64_t>> predecessors(num_threads_);
+
+    auto search = [&](uint64_t i, uint32_t worker_id,
+        std::vector<uint64_t>& visited, std::vector<uint64_t>& dst) -> void {
+
+        auto& distance = distances[worker_id];
+        auto& predecessor = predecessors[worker_id];
+        if (distance.empty()) {
+            distance.resize(nodes_.size(), 0);
+            predecessor.resize(nodes_.size(), -1);
+        }
+        find_bubble(i, distance, predecessor, visited, dst);
+    };
+
+    std::vector<bool> is_changed(nodes_.size(), false);
+    std::vector<uint64_t> changed_nodes;
+
+    uint32_t num_bubbles_popped = 0;
+    for (uint64_t begin = 0; begin < nodes_.size(); begin += kBubbleBatchSize) {
+        uint64_t end = std::min<uint64_t>(nodes_.size(),
+            begin + kBubbleBatchSize);
+
+        std::vector<std::vector<uint64_t>> visited(end - begin);
+        std::vector<std::vector<uint64_t>> edges_for_removal(end - begin);
+
+        parallel_for_workers(begin, end, [&](uint64_t i,
+            uint32_t worker_id) -> void {
+            search(i, worker_id, visited[i - begin],
+                edges_for_removal[i - begin]);
+        });
+
+        for (uint64_t i = begin; i < end; ++i) {
+            const auto& it = visited[i - begin];
+            if (std::any_of(it.begin(), it.end(), [&](uint64_t node_id) {
+                    return is_changed[node_id]; })) {
+
+                visited[i - begin].clear();
+                edges_for_removal[i - begin].clear();
+                search(i, 0, visited[i - begin], edges_for_removal[i - begin]);
+            }
+
+            if (edges_for_removal[i - begin].empty()) {
+                continue;
+            }
+
+            for (const auto& edge_id: edges_for_removal[i - begin]) {
+                mark_edge(edge_id);
+            }
+            for (const auto& edge_id: marked_edges_) {
+                for (auto node_id: {edges_[edge_id].begin_node_,
+                    edges_[edge_id].end_node_}) {
+
+                    if (!is_changed[node_id]) {
+                        is_changed[node_id] = true;
+                        changed_nodes.emplace_back(node_id);
+                    }
+                }
+            }
+            remove_marked_objects(true);
+            ++num_bubbles_popped;
+        }
+
+        for (const auto& it: changed_nodes) {
+            is_changed[it] = false;
+        }
+        changed_nodes.clear();
+    }
+
+    return num_bubbles_popped;
+}
+
+void Graph::find_bubble(uint64_t source, std::vector<uint32_t>& distance,
+    std::vector<int64_t>& predecessor, std::vector<uint64_t>& visited,
+    std::vector<uint64_t>& dst) const {
+
+    visited.emplace_back(source);
+    if (nodes_[source].is_removed_ || nodes_[source].outdegree() < 2) {
+        return;
+    }
 
     auto extract_path = [&](std::vector<uint64_t>& dst, uint64_t source,
         uint64_t sink) -> void {
@@ -1026,11 +1653,11 @@ uint32_t Graph::remove_bubbles() {
     auto calculate_path_length = [&](const std::vector<uint64_t>& path)
         -> uint32_t {
 
-        uint32_t path_length = nodes_[path.back()]->length();
+        uint32_t path_length = nodes_[path.back()].length();
         for (uint64_t i = 0; i < path.size() - 1; ++i) {
-            for (const auto& edge: nodes_[path[i]]->suffix_edges_) {
-                if (edge->end_node_->id_ == (uint64_t) path[i + 1]) {
-                    path_length += edge->length_;
+            for (const auto& edge: suffix_edges(path[i])) {
+                if (edge.end_node_ == path[i + 1]) {
+                    path_length += edge.length_;
                     break;
                 }
             }
@@ -1052,7 +1679,7 @@ uint32_t Graph::remove_bubbles() {
             return false;
         }
         for (const auto& it: path) {
-            uint64_t pair_id = nodes_[it]->pair_->id_;
+            uint64_t pair_id = nodes_[it].pair();
             if (node_set.count(pair_id) != 0) {
                 return false;
             }
@@ -1063,14 +1690,14 @@ uint32_t Graph::remove_bubbles() {
             std::max(path_length, other_path_length) * 0.8) {
 
             for (uint64_t i = 1; i < other_path.size() - 1; ++i) {
-                if (nodes_[other_path[i]]->indegree() > 1 ||
-                    nodes_[other_path[i]]->outdegree() > 1) {
+                if (nodes_[other_path[i]].indegree() > 1 ||
+                    nodes_[other_path[i]].outdegree() > 1) {
                     return false;
                 }
             }
             for (uint64_t i = 1; i < path.size() - 1; ++i) {
-                if (nodes_[path[i]]->indegree() > 1 ||
-                    nodes_[path[i]]->outdegree() > 1) {
+                if (nodes_[path[i]].indegree() > 1 ||
+                    nodes_[path[i]].outdegree() > 1) {
                     return false;
                 }
             }
@@ -1078,109 +1705,102 @@ uint32_t Graph::remove_bubbles() {
         return true;
     };
 
-    uint32_t num_bubbles_popped = 0;
-    for (const auto& node: nodes_) {
-        if (node == nullptr || node->outdegree() < 2) {
-            continue;
-        }
-
-        bool found_sink = false;
-        uint64_t sink = 0, sink_other_predecesor = 0;
-        uint64_t source = node->id_;
+    bool found_sink = false;
+    uint64_t sink = 0, sink_other_predecesor = 0;
 
-        // BFS
-        node_queue.emplace_back(source);
-        visited[visited_length++] = source;
-        while (!node_queue.empty() && !found_sink) {
-            uint64_t v = node_queue.front();
-            const auto& curr_node = nodes_[v];
+    // BFS
+    std::deque<uint64_t> node_queue(1, source);
+    while (!node_queue.empty() && !found_sink) {
+        uint64_t v = node_queue.front();
 
-            node_queue.pop_front();
+        node_queue.pop_front();
 
-            for (const auto& edge: curr_node->suffix_edges_) {
-                uint64_t w = edge->end_node_->id_;
-
-                if (w == source) {
-                    // Cycle
-                    continue;
-                }
+        for (const auto& edge: suffix_edges(v)) {
+            uint64_t w = edge.end_node_;
 
-                if (distance[v] + edge->length_ > 5000000) {
-                    // Out of reach
-                    continue;
-                }
+            if (w == source) {
+                // Cycle
+                continue;
+            }
 
-                distance[w] = distance[v] + edge->length_;
-                visited[visited_length++] = w;
-                node_queue.emplace_back(w);
+            if (distance[v] + edge.length_ > 5000000) {
+                // Out of reach
+                continue;
+            }
 
-                if (predecessor[w] != -1) {
-                    sink = w;
-                    sink_other_predecesor = v;
-                    found_sink = true;
-                    break;
-                }
+            distance[w] = distance[v] + edge.length_;
+            visited.emplace_back(w);
+            node_queue.emplace_back(w);
 
-                predecessor[w] = v;
+            if (predecessor[w] != -1) {
+                sink = w;
+                sink_other_predecesor = v;
+                found_sink = true;
+                break;
             }
-        }
 
-        if (found_sink) {
-            std::vector<uint64_t> path;
-            extract_path(path, source, sink);
+            predecessor[w] = v;
+        }
+    }
 
-            std::vector<uint64_t> other_path(1, sink);
-            extract_path(other_path, source, sink_other_predecesor);
+    if (found_sink) {
+        std::vector<uint64_t> path;
+        extract_path(path, source, sink);
 
-            if (is_valid_bubble(path, other_path)) {
-                uint64_t path_num_reads = 0;
-                for (const auto& it: path) {
-                    path_num_reads += nodes_[it]->sequence_ids_.size();
-                }
+        std::vector<uint64_t> other_path(1, sink);
+        extract_path(other_path, source, sink_other_predecesor);
 
-                uint64_t other_path_num_reads = 0;
-                for (const auto& it: other_path) {
-                    other_path_num_reads += nodes_[it]->sequence_ids_.size();
-                }
+        if (is_valid_bubble(path, other_path)) {
+            uint64_t path_num_reads = 0;
+            for (const auto& it: path) {
+                path_num_reads += nodes_[it].sequence_ids_.size();
+            }
 
-                std::vector<uint64_t> edges_for_removal;
-                if (path_num_reads > other_path_num_reads) {
-                    find_removable_edges(edges_for_removal, other_path);
-                } else {
-                    find_removable_edges(edges_for_removal, path);
-                }
+            uint64_t other_path_num_reads = 0;
+            for (const auto& it: other_path) {
+                other_path_num_reads += nodes_[it].sequence_ids_.size();
+            }
 
-                for (const auto& edge_id: edges_for_removal) {
-                    edges_[edge_id]->is_marked_ = true;
-                    edges_[edge_id]->pair_->is_marked_ = true;
-                    marked_edges_.emplace(edge_id);
-                    marked_edges_.emplace(edges_[edge_id]->pair_->id_);
-                }
-                if (!edges_for_removal.empty()) {
-                    remove_marked_objects(true);
-                    ++num_bubbles_popped;
-                }
+            if (path_num_reads > other_path_num_reads) {
+                find_removable_edges(dst, other_path);
+            } else {
+                find_removable_edges(dst, path);
             }
         }
+    }
 
-        node_queue.clear();
-        for (uint64_t i = 0; i < visited_length; ++i) {
-            distance[visited[i]] = 0;
-            predecessor[visited[i]] = -1;
-        }
-        visited_length = 0;
+    for (const auto& it: visited) {
+        distance[it] = 0;
+        predecessor[it] = -1;
     }
+}
 
-    return num_bubbles_popped;
+Graph::EdgeRange Graph::prefix_edges(uint64_t node_id) const {
+    return EdgeRange(prefix_edge_ids_.data() + prefix_offsets_[node_id],
+        prefix_edge_ids_.data() + prefix_offsets_[node_id + 1], edges_);
+}
+
+Graph::EdgeRange Graph::suffix_edges(uint64_t node_id) const {
+    return EdgeRange(suffix_edge_ids_.data() + suffix_offsets_[node_id],
+        suffix_edge_ids_.data() + suffix_offsets_[node_id + 1], edges_);
+}
+
+void Graph::mark_edge(uint64_t edge_id) {
+    for (auto it: {edge_id, edge_id ^ 1}) {
+        if (!is_marked_edge_[it]) {
+            is_marked_edge_[it] = true;
+            marked_edges_.emplace_back(it);
+        }
+    }
 }
 
-uint64_t Graph::find_edge(uint64_t src, uint64_t dst) {
+uint64_t Graph::find_edge(uint64_t src, uint64_t dst) const {
 
     uint64_t edge_id = 0;
     bool found_edge = false;
-    for (const auto& edge: nodes_[src]->suffix_edges_) {
-        if (edge->end_node_->id_ == dst) {
-            edge_id = edge->id_;
+    for (const auto& edge: suffix_edges(src)) {
+        if (edge.end_node_ == dst) {
+            edge_id = edge.id_;
             found_edge = true;
             break;
         }
@@ -1196,12 +1816,12 @@ uint64_t Graph::find_edge(uint64_t src, uint64_t dst) {
 }
 
 void Graph::find_removable_edges(std::vector<uint64_t>& dst,
-    const std::vector<uint64_t>& path) {
+    const std::vector<uint64_t>& path) const {
 
     // find first node with multiple in edges
     int64_t pref = -1;
     for (uint64_t i = 1; i < path.size() - 1; ++i) {
-        if (nodes_[path[i]]->indegree() > 1) {
+        if (nodes_[path[i]].indegree() > 1) {
             pref = i;
             break;
         }
@@ -1209,7 +1829,7 @@ void Graph::find_removable_edges(std::vector<uint64_t>& dst,
     // find last node with multiple out edges
     int64_t suff = -1;
     for (uint64_t i = 1; i < path.size() - 1; ++i) {
-        if (nodes_[path[i]]->outdegree() > 1) {
+        if (nodes_[path[i]].outdegree() > 1) {
             suff = i;
         }
     }
@@ -1222,10 +1842,10 @@ void Graph::find_removable_edges(std::vector<uint64_t>& dst,
         return;
     }
 
-    if (pref != -1 && nodes_[path[pref]]->outdegree() > 1) {
+    if (pref != -1 && nodes_[path[pref]].outdegree() > 1) {
         return;
     }
-    if (suff != -1 && nodes_[path[suff]]->indegree() > 1) {
+    if (suff != -1 && nodes_[path[suff]].indegree() > 1) {
         return;
     }
 
@@ -1252,44 +1872,46 @@ uint32_t Graph::create_unitigs() {
     std::vector<bool> is_visited(nodes_.size(), false);
 
     uint64_t node_id = nodes_.size();
-    std::vector<std::unique_ptr<Node>> unitigs;
+    std::vector<Node> unitigs;
 
     uint64_t edge_id = edges_.size();
-    std::vector<std::unique_ptr<Edge>> unitig_edges;
+    std::vector<Edge> unitig_edges;
 
     uint32_t num_unitigs_created = 0;
 
+    // unitig edges are attached to junctions only, so degree changes made
+    // in this loop do not alter which nodes are junctions
     for (const auto& it: nodes_) {
-        if (it == nullptr || is_visited[it->id_] || it->is_junction()) {
+        if (it.is_removed_ || is_visited[it.id_] || it.is_junction()) {
             continue;
         }
 
         bool is_circular = false;
-        auto begin_node = it.get();
-        while (!begin_node->is_junction()) {
-            is_visited[begin_node->id_] = true;
-            is_visited[begin_node->pair_->id_] = true;
-            if (begin_node->indegree() == 0 ||
-                begin_node->prefix_edges_[0]->begin_node_->is_junction()) {
+        uint64_t begin_node = it.id_;
+        while (!nodes_[begin_node].is_junction()) {
+            is_visited[begin_node] = true;
+            is_visited[begin_node ^ 1] = true;
+            if (nodes_[begin_node].indegree() == 0 ||
+                nodes_[prefix_edges(begin_node).front().begin_node_].is_junction()) {
                 break;
             }
-            begin_node = begin_node->prefix_edges_[0]->begin_node_;
-            if (begin_node->id_ == it->id_) {
+            begin_node = prefix_edges(begin_node).front().begin_node_;
+            if (begin_node == it.id_) {
                 is_circular = true;
                 break;
             }
         }
 
-        auto end_node = it.get();
-        while (!end_node->is_junction()) {
-            is_visited[end_node->id_] = true;
-            is_visited[end_node->pair_->id_] = true;
-            if (end_node->outdegree() == 0 ||
-                end_node->suffix_edges_[0]->end_node_->is_junction()) {
+        uint64_t end_node = it.id_;
+        while (!nodes_[end_node].is_junction()) {
+            is_visited[end_node] = true;
+            is_visited[end_node ^ 1] = true;
+            if (nodes_[end_node].outdegree() == 0 ||
+                nodes_[suffix_edges(end_node).front().end_node_].is_junction()) {
                 break;
             }
-            end_node = end_node->suffix_edges_[0]->end_node_;
-            if (end_node->id_ == it->id_) {
+            end_node = suffix_edges(end_node).front().end_node_;
+            if (end_node == it.id_) {
                 is_circular = true;
                 break;
             }
@@ -1299,186 +1921,228 @@ uint32_t Graph::create_unitigs() {
             continue;
         }
 
-        std::unique_ptr<Node> unitig(new Node(node_id++, begin_node, end_node));
-        std::unique_ptr<Node> unitig_complement(new Node(node_id++,
-            end_node->pair_, begin_node->pair_));
+        unitigs.emplace_back(node_id++, begin_node, end_node, *this);
+        unitigs.emplace_back(node_id++, end_node ^ 1, begin_node ^ 1, *this);
 
-        unitig->pair_ = unitig_complement.get();
-        unitig_complement->pair_ = unitig.get();
+        auto& unitig = unitigs[unitigs.size() - 2];
+        auto& unitig_complement = unitigs.back();
 
         if (begin_node != end_node) {
-            if (begin_node->indegree() != 0) {
-                const auto& edge = begin_node->prefix_edges_[0];
-
-                edge->is_marked_ = true;
-                edge->pair_->is_marked_ = true;
-                marked_edges_.emplace(edge->id_);
-                marked_edges_.emplace(edge->pair_->id_);
-
-                std::unique_ptr<Edge> unitig_edge(new Edge(edge_id++,
-                    edge->begin_node_, unitig.get(), edge->length_));
-                std::unique_ptr<Edge> unitig_edge_complement(new Edge(edge_id++,
-                    unitig_complement.get(), edge->pair_->end_node_,
-                    edge->pair_->length_ + unitig_complement->length() -
-                    begin_node->pair_->length()));
-
-                unitig_edge->pair_ = unitig_edge_complement.get();
-                unitig_edge_complement->pair_ = unitig_edge.get();
-
-                edge->begin_node_->suffix_edges_.emplace_back(unitig_edge.get());
-                edge->pair_->end_node_->prefix_edges_.emplace_back(
-                    unitig_edge_complement.get());
-                unitig->prefix_edges_.emplace_back(unitig_edge.get());
-                unitig_complement->suffix_edges_.emplace_back(
-                    unitig_edge_complement.get());
-
-                unitig_edges.emplace_back(std::move(unitig_edge));
-                unitig_edges.emplace_back(std::move(unitig_edge_complement));
+            if (nodes_[begin_node].indegree() != 0) {
+                const auto& edge = prefix_edges(begin_node).front();
+                const auto& edge_complement = edges_[edge.pair()];
+
+                mark_edge(edge.id_);
+
+                unitig_edges.emplace_back(edge_id++, edge.begin_node_,
+                    unitig.id_, edge.length_);
+                unitig_edges.emplace_back(edge_id++, unitig_complement.id_,
+                    edge_complement.end_node_, edge_complement.length_ +
+                    unitig_complement.length() - nodes_[begin_node ^ 1].length());
+
+                ++nodes_[edge.begin_node_].outdegree_;
+                ++nodes_[edge_complement.end_node_].indegree_;
+                ++unitig.indegree_;
+                ++unitig_complement.outdegree_;
             }
 
-            if (end_node->outdegree() != 0) {
-                const auto& edge = end_node->suffix_edges_[0];
-
-                edge->is_marked_ = true;
-                edge->pair_->is_marked_ = true;
-                marked_edges_.emplace(edge->id_);
-                marked_edges_.emplace(edge->pair_->id_);
-
-                std::unique_ptr<Edge> unitig_edge(new Edge(edge_id++,
-                    unitig.get(), edge->end_node_, edge->length_ +
-                    unitig->length() - end_node->length()));
-                std::unique_ptr<Edge> unitig_edge_complement(new Edge(edge_id++,
-                    edge->pair_->begin_node_, unitig_complement.get(),
-                    edge->pair_->length_));
+            if (nodes_[end_node].outdegree() != 0) {
+                const auto& edge = suffix_edges(end_node).front();
+                const auto& edge_complement = edges_[edge.pair()];
 
-                unitig_edge->pair_ = unitig_edge_complement.get();
-                unitig_edge_complement->pair_ = unitig_edge.get();
+                mark_edge(edge.id_);
 
-                unitig->suffix_edges_.emplace_back(unitig_edge.get());
-                unitig_complement->prefix_edges_.emplace_back(
-                    unitig_edge_complement.get());
-                edge->end_node_->prefix_edges_.emplace_back(unitig_edge.get());
-                edge->pair_->begin_node_->suffix_edges_.emplace_back(
-                    unitig_edge_complement.get());
+                unitig_edges.emplace_back(edge_id++, unitig.id_,
+                    edge.end_node_, edge.length_ + unitig.length() -
+                    nodes_[end_node].length());
+                unitig_edges.emplace_back(edge_id++,
+                    edge_complement.begin_node_, unitig_complement.id_,
+                    edge_complement.length_);
 
-                unitig_edges.emplace_back(std::move(unitig_edge));
-                unitig_edges.emplace_back(std::move(unitig_edge_complement));
+                ++unitig.outdegree_;
+                ++unitig_complement.indegree_;
+                ++nodes_[edge.end_node_].indegree_;
+                ++nodes_[edge_complement.begin_node_].outdegree_;
             }
         }
 
-        unitigs.emplace_back(std::move(unitig));
-        unitigs.emplace_back(std::move(unitig_complement));
-
         ++num_unitigs_created;
 
         // mark edges for deletion
         auto node = begin_node;
         while (true) {
-            const auto& edge = node->suffix_edges_[0];
+            const auto& edge = suffix_edges(node).front();
 
-            edge->is_marked_ = true;
-            edge->pair_->is_marked_ = true;
-            marked_edges_.emplace(edge->id_);
-            marked_edges_.emplace(edge->pair_->id_);
+            mark_edge(edge.id_);
 
-            node = edge->end_node_;
+            node = edge.end_node_;
             if (node == end_node) {
                 break;
             }
         }
     }
 
-    for (uint64_t i = 0; i < unitigs.size(); ++i) {
-        nodes_.emplace_back(std::move(unitigs[i]));
-    }
-    for (uint64_t i = 0; i < unitig_edges.size(); ++i) {
-        edges_.emplace_back(std::move(unitig_edges[i]));
+    nodes_.reserve(nodes_.size() + unitigs.size());
+    for (auto& it: unitigs) {
+        nodes_.emplace_back(std::move(it));
     }
+    edges_.insert(edges_.end(), unitig_edges.begin(), unitig_edges.end());
+    is_marked_edge_.resize(edges_.size(), false);
 
+    if (num_unitigs_created != 0) {
+        compact();
+    }
     remove_marked_objects(true);
 
     return num_unitigs_created;
 }
 
+bool Graph::is_contig(const Node& node,
+    bool drop_unassembled_sequences) const {
+
+    if (node.is_removed_ || node.is_rc()) {
+        return false;
+    }
+    return !drop_unassembled_sequences || (node.sequence_ids_.size() >= 6 &&
+        node.length() >= 10000);
+}
+
+void Graph::contig_name(const Node& node, uint32_t contig_id,
+    std::string& dst) const {
+
+    dst.assign(">Ctg");
+    appendNumber(dst, contig_id);
+    dst.append(" RC:i:");
+    appendNumber(dst, node.sequence_ids_.size());
+    dst.append(" LN:i:");
+    appendNumber(dst, node.length());
+    dst.append(" Seqs:");
+    for (const auto& it: node.sequence_ids_) {
+        appendNumber(dst, it);
+        dst.push_back(',');
+    }
+    if (!node.sequence_ids_.empty()) {
+        dst.pop_back();
+    }
+}
+
 void Graph::extract_contigs(std::vector<std::unique_ptr<Sequence>>& dst,
     bool drop_unassembled_sequences) const {
 
     uint32_t contig_id = 0;
     std::vector<uint32_t> contig_length;
+    std::string name;
     for (const auto& node: nodes_) {
-        if (node == nullptr || node->is_rc()) {
+        if (!is_contig(node, drop_unassembled_sequences)) {
             continue;
         }
-        if (drop_unassembled_sequences && (node->sequence_ids_.size() < 6 ||
-            node->length() < 10000)) {
+        contig_length.emplace_back(node.length());
+
+        contig_name(node, contig_id, name);
+        dst.emplace_back(createSequence(name, node.packed_data()));
+        ++contig_id;
+    }
+
+    printContigStats(contig_length);
+}
+
+void Graph::write_contigs(OutputFile* dst, bool drop_unassembled_sequences,
+    uint32_t line_width) const {
+
+    uint32_t contig_id = 0;
+    std::vector<uint32_t> contig_length;
+    std::string buffer;
+    for (const auto& node: nodes_) {
+        if (!is_contig(node, drop_unassembled_sequences)) {
             continue;
         }
-        contig_length.emplace_back(node->data_.size());
-
-        std::string name = ">Ctg" + std::to_string(contig_id);
-        name += " RC:i:" + std::to_string(node->sequence_ids_.size());
-        name += " LN:i:" + std::to_string(node->data_.size());
+        contig_length.emplace_back(node.length());
 
-        std::ostringstream seqss;
-        std::copy(node->sequence_ids_.begin(), node->sequence_ids_.end() - 1,
-            std::ostream_iterator<int>(seqss, ","));
-        seqss << node->sequence_ids_.back();
-        name += " Seqs:" + seqss.str();
+        contig_name(node, contig_id, buffer);
+        buffer.push_back('\n');
+        dst->write(buffer);
 
-        dst.emplace_back(createSequence(name, node->data_));
+        node.write(line_width, buffer, dst);
+        dst->write("\n", 1);
         ++contig_id;
     }
 
-    fprintf(stderr, "[rala::Graph::extract_contigs] number of contigs = %zu\n",
-        contig_length.size());
+    printContigStats(contig_length);
+}
 
-    if (contig_length.empty()) {
-        return;
-    }
+uint64_t Graph::detach_marked_edges(uint64_t begin) {
 
-    std::sort(contig_length.begin(), contig_length.end());
+    for (uint64_t i = begin; i < marked_edges_.size(); ++i) {
+        auto& edge = edges_[marked_edges_[i]];
+        if (edge.is_removed_) {
+            continue;
+        }
+        edge.is_removed_ = true;
+        --nodes_[edge.begin_node_].outdegree_;
+        --nodes_[edge.end_node_].indegree_;
+        ++num_removed_edges_;
+    }
 
-    fprintf(stderr, "[rala::Graph::extract_contigs] shortest contig length = %u\n",
-        contig_length.front());
-    fprintf(stderr, "[rala::Graph::extract_contigs] median contig length = %u\n",
-        contig_length[contig_length.size() / 2]);
-    fprintf(stderr, "[rala::Graph::extract_contigs] longest contig length = %u\n",
-        contig_length.back());
+    return marked_edges_.size();
 }
 
 void Graph::remove_marked_objects(bool remove_nodes) {
 
-    auto delete_edges = [&](std::vector<Edge*>& edges) -> void {
-        for (uint32_t i = 0; i < edges.size(); ++i) {
-            if (edges[i]->is_marked_) {
-                edges[i] = nullptr;
+    detach_marked_edges(0);
+
+    if (remove_nodes) {
+        for (const auto& it: marked_edges_) {
+            for (auto node_id: {edges_[it].begin_node_, edges_[it].end_node_}) {
+                auto& node = nodes_[node_id];
+                if (!node.is_removed_ && node.outdegree() == 0 &&
+                    node.indegree() == 0) {
+                    node.remove();
+                }
             }
         }
-        shrinkToFit(edges, 0);
-    };
+    }
 
-    std::unordered_set<uint32_t> marked_nodes;
-    for (const auto& it: marked_edges_) {
-        if (remove_nodes) {
-            marked_nodes.emplace(edges_[it]->begin_node_->id_);
-            marked_nodes.emplace(edges_[it]->end_node_->id_);
-        }
-        delete_edges(edges_[it]->begin_node_->suffix_edges_);
-        delete_edges(edges_[it]->end_node_->prefix_edges_);
+    marked_edges_.clear();
+
+    if (2 * num_removed_edges_ > suffix_edge_ids_.size()) {
+        compact();
     }
+}
 
-    if (remove_nodes) {
-        for (const auto& it: marked_nodes) {
-            if (nodes_[it]->outdegree() == 0 && nodes_[it]->indegree() == 0) {
-                nodes_[it].reset();
+void Graph::compact() {
+
+    auto build_rows = [&](std::vector<uint64_t>& offsets,
+        std::vector<uint64_t>& edge_ids, bool is_prefix) -> void {
+
+        offsets.assign(nodes_.size() + 1, 0);
+        for (const auto& it: edges_) {
+            if (!it.is_removed_) {
+                ++offsets[(is_prefix ? it.end_node_ : it.begin_node_) + 1];
             }
         }
-    }
+        for (uint64_t i = 1; i < offsets.size(); ++i) {
+            offsets[i] += offsets[i - 1];
+        }
 
-    for (const auto& it: marked_edges_) {
-        edges_[it].reset();
-    }
-    marked_edges_.clear();
+        // edges are visited by ascending ids which keeps rows in the order
+        // of edge creation
+        std::vector<uint64_t>(offsets.back()).swap(edge_ids);
+        for (const auto& it: edges_) {
+            if (!it.is_removed_) {
+                edge_ids[offsets[is_prefix ? it.end_node_ : it.begin_node_]++] =
+                    it.id_;
+            }
+        }
+        for (uint64_t i = offsets.size() - 1; i > 0; --i) {
+            offsets[i] = offsets[i - 1];
+        }
+        offsets[0] = 0;
+    };
+
+    build_rows(prefix_offsets_, prefix_edge_ids_, true);
+    build_rows(suffix_offsets_, suffix_edge_ids_, false);
+
+    num_removed_edges_ = 0;
 }
 
 void Graph::print_csv(std::string path) const {
@@ -1486,72 +2150,117 @@ void Graph::print_csv(std::string path) const {
     auto graph_file = fopen(path.c_str(), "w");
 
     for (const auto& it: nodes_) {
-        if (it == nullptr || !it->is_rc()) {
+        if (it.is_removed_ || !it.is_rc()) {
             continue;
         }
+        const auto& pair = nodes_[it.pair()];
         fprintf(graph_file, "%lu LN:i:%u RC:i:%lu,%lu LN:i:%u RC:i:%lu,0,-\n",
-            it->id_, it->length(), it->sequence_ids_.size(),
-            it->pair_->id_, it->pair_->length(), it->pair_->sequence_ids_.size());
+            it.id_, it.length(), it.sequence_ids_.size(),
+            pair.id_, pair.length(), pair.sequence_ids_.size());
     }
 
     for (const auto& it: edges_) {
-        if (it == nullptr) {
+        if (it.is_removed_) {
             continue;
         }
+        const auto& begin_node = nodes_[it.begin_node_];
+        const auto& end_node = nodes_[it.end_node_];
         fprintf(graph_file, "%lu LN:i:%u RC:i:%lu,%lu LN:i:%u RC:i:%lu,1,%lu %u\n",
-            it->begin_node_->id_, it->begin_node_->length(), it->begin_node_->sequence_ids_.size(),
-            it->end_node_->id_, it->end_node_->length(), it->end_node_->sequence_ids_.size(),
-            it->id_, it->length_);
+            begin_node.id_, begin_node.length(), begin_node.sequence_ids_.size(),
+            end_node.id_, end_node.length(), end_node.sequence_ids_.size(),
+            it.id_, it.length_);
     }
 
     fclose(graph_file);
 }
 
-void Graph::print_gfa(std::string path) const {
+void Graph::print_gfa(const std::string& path,
+    bool is_sequence_separate) const {
 
-    auto graph_file = fopen(path.c_str(), "w");
+    auto graph_file = createOutputFile(path, Compression::kNone, 1);
+
+    std::unique_ptr<OutputFile> sequence_file;
+    if (is_sequence_separate) {
+        auto sequence_path = path;
+        if (sequence_path.size() > 4 &&
+            sequence_path.compare(sequence_path.size() - 4, 4, ".gfa") == 0) {
+            sequence_path.resize(sequence_path.size() - 4);
+        }
+        sequence_file = createOutputFile(sequence_path + ".fasta",
+            Compression::kNone, 1);
+    }
 
-    std::unordered_map<uint64_t, std::string> node_id_to_unitig_name;
-    uint32_t unitig_id = 0;
+    // unitigs (nodes without a name) are numbered in order of appearance,
+    // a node and its pair share the name
+    std::vector<uint32_t> unitig_ids(nodes_.size() / 2 + 1, 0);
+    uint32_t num_unitigs = 0;
 
+    auto append_name = [&](const Node& node, std::string& dst) -> void {
+        if (!node.name_.empty()) {
+            dst.append(node.name_);
+        } else {
+            dst.append("Utg");
+            appendNumber(dst, unitig_ids[node.id_ >> 1]);
+        }
+    };
+
+    std::string line, buffer;
     for (const auto& it: nodes_) {
-        if (it == nullptr || it->is_rc()) {
+        if (it.is_removed_ || it.is_rc()) {
             continue;
         }
-        if (it->name_.empty()) {
-            std::string unitig_name = "Utg" + std::to_string(unitig_id++);
-            node_id_to_unitig_name[it->id_] = unitig_name;
-            node_id_to_unitig_name[it->pair_->id_] = unitig_name;
+        if (it.name_.empty()) {
+            unitig_ids[it.id_ >> 1] = num_unitigs++;
         }
 
-        const auto& node_name = !it->name_.empty() ? it->name_ :
-            node_id_to_unitig_name[it->id_];
+        line.assign("S\t");
+        append_name(it, line);
+        line.push_back('\t');
+
+        if (sequence_file != nullptr) {
+            buffer.assign(">");
+            append_name(it, buffer);
+            buffer.push_back('\n');
+            sequence_file->write(buffer);
+            it.write(0, buffer, sequence_file.get());
+            sequence_file->write("\n", 1);
 
-        fprintf(graph_file, "S\t%s\t%s\tLN:i:%zu\tRC:i:%lu\n",
-            node_name.c_str(), it->data_.c_str(), it->data_.size(),
-            it->sequence_ids_.size());
+            line.push_back('*');
+        } else {
+            graph_file->write(line);
+            it.write(0, buffer, graph_file.get());
+            line.clear();
+        }
+
+        line.append("\tLN:i:");
+        appendNumber(line, it.length());
+        line.append("\tRC:i:");
+        appendNumber(line, it.sequence_ids_.size());
+        line.push_back('\n');
+        graph_file->write(line);
     }
 
     for (const auto& it: edges_) {
-        if (it == nullptr) {
+        if (it.is_removed_) {
             continue;
         }
+        const auto& begin_node = nodes_[it.begin_node_];
+        const auto& end_node = nodes_[it.end_node_];
 
-        const auto& begin_node_name = nodes_[it->begin_node_->id_]->name_.empty() ?
-            nodes_[it->begin_node_->id_]->name_ :
-            node_id_to_unitig_name[it->begin_node_->id_];
-
-        const auto& end_node_name = !nodes_[it->end_node_->id_]->name_.empty() ?
-            nodes_[it->end_node_->id_]->name_ :
-            node_id_to_unitig_name[it->end_node_->id_];
-
-        fprintf(graph_file, "L\t%s\t%c\t%s\t%c\t%zuM\n",
-            begin_node_name.c_str(), it->begin_node_->is_rc() ? '-' : '+',
-            end_node_name.c_str(), it->end_node_->is_rc() ? '-' : '+',
-            it->begin_node_->data_.size() - it->length_);
+        line.assign("L\t");
+        append_name(begin_node, line);
+        line.append(begin_node.is_rc() ? "\t-\t" : "\t+\t");
+        append_name(end_node, line);
+        line.append(end_node.is_rc() ? "\t-\t" : "\t+\t");
+        appendNumber(line, begin_node.length() - it.length_);
+        line.append("M\n");
+        graph_file->write(line);
     }
 
-    fclose(graph_file);
+    graph_file->close();
+    if (sequence_file != nullptr) {
+        sequence_file->close();
+    }
 }
 
 void Graph::print_json(std::string path) const {
@@ -1562,7 +2271,7 @@ void Graph::print_json(std::string path) const {
 
     std::unordered_set<uint64_t> sequence_ids;
     for (const auto& it: nodes_) {
-        if (it == nullptr || it->is_rc() || !it->is_junction()) {
+        if (it.is_removed_ || it.is_rc() || !it.is_junction()) {
             continue;
         }
 
@@ -1570,35 +2279,39 @@ void Graph::print_json(std::string path) const {
             os << ",";
         }
         is_first = false;
-        os << "\"" << it->sequence_ids_.front() << "\":{";
+        os << "\"" << it.sequence_ids_.front() << "\":{";
 
         os << "\"p\":[";
 
-        sequence_ids.emplace(it->sequence_ids_.front());
-        for (uint32_t i = 0; i < it->prefix_edges_.size(); ++i) {
-            auto other = it->prefix_edges_[i]->begin_node_;
-            sequence_ids.emplace(other->sequence_ids_.back());
+        sequence_ids.emplace(it.sequence_ids_.front());
+        bool is_first_edge = true;
+        for (const auto& edge: prefix_edges(it.id_)) {
+            const auto& other = nodes_[edge.begin_node_];
+            sequence_ids.emplace(other.sequence_ids_.back());
 
-            os << "[\"" << other->sequence_ids_.back() << "\",\"" <<
-                other->id_ << "\"," << other->is_last_rc_ << "," <<
-                other->length() - it->prefix_edges_[i]->length_ << "]";
-            if (i < it->prefix_edges_.size() - 1) {
+            if (!is_first_edge) {
                 os << ",";
             }
+            is_first_edge = false;
+            os << "[\"" << other.sequence_ids_.back() << "\",\"" <<
+                other.id_ << "\"," << other.is_last_rc_ << "," <<
+                other.length() - edge.length_ << "]";
         }
 
         os << "],\"s\":[";
 
-        for (uint32_t i = 0; i < it->suffix_edges_.size(); ++i) {
-            auto other = it->suffix_edges_[i]->end_node_;
-            sequence_ids.emplace(other->sequence_ids_.front());
+        is_first_edge = true;
+        for (const auto& edge: suffix_edges(it.id_)) {
+            const auto& other = nodes_[edge.end_node_];
+            sequence_ids.emplace(other.sequence_ids_.front());
 
-            os << "[\"" << other->sequence_ids_.front() << "\",\"" <<
-                other->id_ << "\"," << other->is_first_rc_ << "," <<
-                it->length() - it->suffix_edges_[i]->length_ << "]";
-            if (i < it->suffix_edges_.size() - 1) {
+            if (!is_first_edge) {
                 os << ",";
             }
+            is_first_edge = false;
+            os << "[\"" << other.sequence_ids_.front() << "\",\"" <<
+                other.id_ << "\"," << other.is_first_rc_ << "," <<
+                it.length() - edge.length_ << "]";
         }
 
         os << "]}";
@@ -28,11 +28,18 @@ namespace rala {
 class Sequence;
 class Pile;
 class Overlap;
+class OverlapStore;
+class PafReader;
+class InputFile;
+class OutputFile;
+class Arena;
+class SequenceIndex;
 
 class Graph;
 std::unique_ptr<Graph> createGraph(const std::string& sequences_path,
     const std::string& overlaps_path, const std::string& mcl_out_path,
-        int32_t mcl_group, uint32_t num_threads);
+        int32_t mcl_group, uint32_t num_threads, uint64_t max_store_size,
+        bool use_overlap_cache, bool compress_piles);
 
 class Graph {
 public:
@@ -46,9 +53,13 @@ public:
     void construct(bool preprocess = true);
 
     /*!
-     * @brief Removes transitive edges and tips, pops bubbles
+     * @brief Removes transitive edges and tips, pops bubbles; if gfa_prefix
+     * is set, the graph is printed with print_gfa() before the first and
+     * after each stage into gfa_prefix_<stage number>_<stage name>.gfa
      */
-    void simplify(const std::string& debug_prefix);
+    void simplify(const std::string& debug_prefix,
+        const std::string& gfa_prefix = "",
+        bool is_gfa_sequence_separate = false);
 
     /*!
      * @brief Reads ids of assembly group
@@ -88,15 +99,27 @@ public:
     void extract_contigs(std::vector<std::unique_ptr<Sequence>>& dst,
         bool drop_unassembled_sequences = true) const;
 
+    /*!
+     * @brief Writes all contigs in FASTA format to dst straight from graph
+     * nodes (sequence lines are wrapped at line_width bases, 0 disables
+     * wrapping)
+     */
+    void write_contigs(OutputFile* dst, bool drop_unassembled_sequences = true,
+        uint32_t line_width = 0) const;
+
     /*!
      * @brief Prints assembly graph in csv format
      */
     void print_csv(std::string path) const;
 
     /*!
-     * @brief Prints assembly graph in GFA format
+     * @brief Prints assembly graph in GFA format; segment sequences are
+     * streamed from nodes or, if is_sequence_separate is set, replaced with
+     * '*' and written into a FASTA file next to path (.gfa is replaced with
+     * .fasta)
      */
-    void print_gfa(std::string path) const;
+    void print_gfa(const std::string& path,
+        bool is_sequence_separate = false) const;
 
     /*!
      * @brief Prints all unresolved graph junctions in JSON format (plottable
@@ -106,13 +129,27 @@ public:
 
     friend std::unique_ptr<Graph> createGraph(const std::string& sequences_path,
         const std::string& overlaps_path, const std::string& mcl_out_path,
-        int32_t mcl_group, uint32_t num_threads);
+        int32_t mcl_group, uint32_t num_threads, uint64_t max_store_size,
+        bool use_overlap_cache, bool compress_piles);
 private:
-    Graph(std::unique_ptr<bioparser::Parser<Sequence>> sparser,
-        std::unique_ptr<bioparser::Parser<Overlap>> oparser,
+    using SequenceParserCreator = std::unique_ptr<bioparser::Parser<Sequence>>
+        (*)(const std::string&);
+    using OverlapParserCreator = std::unique_ptr<bioparser::Parser<Overlap>>
+        (*)(const std::string&);
+
+    Graph(const std::string& sequences_path,
+        std::unique_ptr<InputFile> sequences_file,
+        SequenceParserCreator create_sparser,
+        const std::string& overlaps_path,
+        std::unique_ptr<InputFile> overlaps_file,
+        OverlapParserCreator create_oparser,
         const std::string& mcl_out_path,
         int32_t mcl_group,
-        uint32_t num_threads);
+        uint32_t num_threads,
+        std::unique_ptr<thread_pool::ThreadPool> thread_pool,
+        uint64_t max_store_size,
+        bool use_overlap_cache,
+        bool compress_piles);
     Graph(const Graph&) = delete;
     const Graph& operator=(const Graph&) = delete;
 
@@ -127,34 +164,147 @@ private:
      */
     void preprocess();
 
-    uint64_t find_edge(uint64_t src, uint64_t dst);
+    class EdgeRange;
+
+    /*!
+     * @brief Returns live edges ending in (prefix) or starting from (suffix)
+     * a node, in the order of their creation
+     */
+    EdgeRange prefix_edges(uint64_t node_id) const;
+    EdgeRange suffix_edges(uint64_t node_id) const;
+
+    /*!
+     * @brief Marks an edge and its pair for removal by remove_marked_objects()
+     */
+    void mark_edge(uint64_t edge_id);
+
+    /*!
+     * @brief Rebuilds CSR rows from all live edges, dropping tombstones
+     */
+    void compact();
+
+    uint64_t find_edge(uint64_t src, uint64_t dst) const;
+
+    /*!
+     * @brief Searches for a bubble starting at source with a bounded BFS and
+     * stores edges which pop it into dst; all nodes whose state was inspected
+     * are stored into visited (distance and predecessor are scratch arrays of
+     * zeros and -1s which are restored before returning)
+     */
+    void find_bubble(uint64_t source, std::vector<uint32_t>& distance,
+        std::vector<int64_t>& predecessor, std::vector<uint64_t>& visited,
+        std::vector<uint64_t>& dst) const;
 
     /*!
      * @brief Finds edges in path which do not affect the connectivity of the
      * rest of the graph if removed
      */
     void find_removable_edges(std::vector<uint64_t>& dst,
-        const std::vector<uint64_t>& path);
+        const std::vector<uint64_t>& path) const;
 
+    /*!
+     * @brief Tombstones marked edges starting from marked_edges_[begin] and
+     * updates node degrees, but keeps them marked for a later
+     * remove_marked_objects(); returns the number of marked edges
+     */
+    uint64_t detach_marked_edges(uint64_t begin);
+
+    /*!
+     * @brief Tombstones all marked edges and, if remove_nodes is set, their
+     * end nodes which were left without edges
+     */
     void remove_marked_objects(bool remove_nodes = false);
 
+    /*!
+     * @brief Rewinds the input file and creates a parser for a new pass
+     */
+    void reset_sparser();
+    void reset_oparser();
+
+    /*!
+     * @brief Calls function(i) for each i in [begin, end> on thread_pool_;
+     * workers claim chunks of indices from a shared counter and chunks shrink
+     * with the remaining work, so that one future is created per worker and
+     * piles of skewed lengths are balanced
+     */
+    template<typename T>
+    void parallel_for(uint64_t begin, uint64_t end, const T& function);
+
+    /*!
+     * @brief Same as parallel_for but calls function(i, worker_id), with
+     * worker_id in [0, num_threads_>, so that workers can use their own
+     * scratch space
+     */
+    template<typename T>
+    void parallel_for_workers(uint64_t begin, uint64_t end, const T& function);
+
+    /*!
+     * @brief Loads overlaps in chunks from store (or from paf_reader_ or
+     * oparser_ if store is nullptr) on a dedicated thread and passes them to consume(chunk, status)
+     * on the calling thread, status being false for the last chunk; loading
+     * of the next chunk overlaps with consumption of the current one and at
+     * most kMaxQueuedChunks loaded chunks wait to be consumed
+     */
+    template<typename T, typename F>
+    void stream_overlaps(OverlapStore* store, bool valid_only, const F& consume);
+
     class Node;
     class Edge;
 
+    /*!
+     * @brief Returns true if node is written by extract_contigs() and
+     * write_contigs()
+     */
+    bool is_contig(const Node& node, bool drop_unassembled_sequences) const;
+
+    /*!
+     * @brief Stores the FASTA header of a contig into dst
+     */
+    void contig_name(const Node& node, uint32_t contig_id,
+        std::string& dst) const;
+
+    // input files inflate BGZF blocks on thread_pool_ which therefore has to
+    // outlive them
+    uint32_t num_threads_;
+    std::unique_ptr<thread_pool::ThreadPool> thread_pool_;
+
+    std::string sequences_path_;
+    std::unique_ptr<InputFile> sequences_file_;
+    SequenceParserCreator create_sparser_;
     std::unique_ptr<bioparser::Parser<Sequence>> sparser_;
-    std::unordered_map<std::string, uint64_t> name_to_id_;
+    std::unique_ptr<SequenceIndex> sequence_index_;
 
     std::vector<std::unique_ptr<Pile>> piles_;
     uint32_t coverage_median_;
+    bool compress_piles_;
 
+    std::string overlaps_path_;
+    std::unique_ptr<InputFile> overlaps_file_;
+    OverlapParserCreator create_oparser_;
     std::unique_ptr<bioparser::Parser<Overlap>> oparser_;
+    std::unique_ptr<PafReader> paf_reader_;
     std::vector<bool> is_valid_overlap_;
-
-    std::unique_ptr<thread_pool::ThreadPool> thread_pool_;
-
-    std::vector<std::unique_ptr<Node>> nodes_;
-    std::vector<std::unique_ptr<Edge>> edges_;
-    std::unordered_set<uint64_t> marked_edges_;
+    uint64_t max_store_size_;
+    std::string overlap_cache_path_;
+    std::unique_ptr<OverlapStore> overlap_store_;
+
+    // per node data (sequence ids, segments, shared reads) is allocated from
+    // arena_ which therefore has to outlive nodes_
+    std::unique_ptr<Arena> arena_;
+
+    // nodes and edges are indexed by their ids (pairs have adjacent ids),
+    // removed ones are kept as tombstones; adjacency is stored as compressed
+    // sparse rows of edge ids which are rebuilt by compact()
+    std::vector<Node> nodes_;
+    std::vector<Edge> edges_;
+    std::vector<uint64_t> prefix_offsets_;
+    std::vector<uint64_t> prefix_edge_ids_;
+    std::vector<uint64_t> suffix_offsets_;
+    std::vector<uint64_t> suffix_edge_ids_;
+    uint64_t num_removed_edges_;
+    // edges marked for removal, deduplicated through a bit per edge
+    std::vector<bool> is_marked_edge_;
+    std::vector<uint64_t> marked_edges_;
     std::unordered_set<uint64_t> group_reads_;
     bool filter_group;
 };
@@ -0,0 +1,332 @@
+/*!
+ * @file input_file.cpp
+ *
+ * @brief InputFile class source file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <zlib.h>
+
+#include "input_file.hpp"
+
+#include "thread_pool/thread_pool.hpp"
+
+namespace rala {
+
+constexpr uint32_t kBufferSize = 1024 * 1024;
+constexpr uint32_t kBgzfHeaderSize = 12;
+constexpr uint32_t kBgzfBatchSize = 64; // blocks of at most 64kB
+
+uint32_t readLE(const unsigned char* src, uint32_t num_bytes) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < num_bytes; ++i) {
+        value |= static_cast<uint32_t>(src[i]) << (8 * i);
+    }
+    return value;
+}
+
+/*!
+ * @brief Returns the size of a BGZF block from its header (extra field has to
+ * contain the BC subfield), or 0 if the header does not belong to BGZF
+ */
+uint32_t bgzfBlockSize(const unsigned char* header, const unsigned char* extra,
+    uint32_t extra_length) {
+
+    if (header[0] != 31 || header[1] != 139 || header[2] != 8 ||
+        !(header[3] & 4)) {
+        return 0;
+    }
+    for (uint32_t i = 0; i + 4 <= extra_length;) {
+        uint32_t subfield_length = readLE(extra + i + 2, 2);
+        if (extra[i] == 'B' && extra[i + 1] == 'C' && subfield_length == 2 &&
+            i + 6 <= extra_length) {
+            return readLE(extra + i + 4, 2) + 1;
+        }
+        i += 4 + subfield_length;
+    }
+    return 0;
+}
+
+/*!
+ * @brief Inflates consecutive BGZF blocks stored in src (block i spans
+ * [offsets[i], offsets[i + 1]>)
+ */
+std::vector<char> bgzfInflate(const std::vector<unsigned char>& src,
+    const std::vector<uint32_t>& offsets, const std::string& path) {
+
+    std::vector<char> dst;
+
+    for (uint32_t i = 0; i + 1 < offsets.size(); ++i) {
+        const unsigned char* block = src.data() + offsets[i];
+        uint32_t block_size = offsets[i + 1] - offsets[i];
+        uint32_t data_begin = kBgzfHeaderSize + readLE(block + 10, 2);
+
+        uint32_t crc = readLE(block + block_size - 8, 4);
+        uint32_t size = readLE(block + block_size - 4, 4);
+        if (size == 0) {
+            continue; // end-of-file marker (or any other empty block)
+        }
+
+        uint64_t dst_size = dst.size();
+        dst.resize(dst_size + size);
+
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        bool is_valid = inflateInit2(&stream, -15) == Z_OK;
+        if (is_valid) {
+            stream.next_in = const_cast<unsigned char*>(block + data_begin);
+            stream.avail_in = block_size - data_begin - 8;
+            stream.next_out = reinterpret_cast<unsigned char*>(dst.data() +
+                dst_size);
+            stream.avail_out = size;
+
+            is_valid = inflate(&stream, Z_FINISH) == Z_STREAM_END &&
+                stream.avail_out == 0;
+            inflateEnd(&stream);
+        }
+        if (!is_valid || crc32(crc32(0, nullptr, 0), reinterpret_cast<unsigned
+            char*>(dst.data() + dst_size), size) != crc) {
+
+            fprintf(stderr, "[rala::InputFile::decompress_bgzf] error: "
+                "corrupted block in file %s!\n", path.c_str());
+            exit(1);
+        }
+    }
+
+    return dst;
+}
+
+std::unique_ptr<InputFile> createInputFile(const std::string& path,
+    thread_pool::ThreadPool* thread_pool, uint32_t num_threads) {
+
+    FILE* input = fopen(path.c_str(), "rb");
+    if (input == nullptr) {
+        fprintf(stderr, "[rala::createInputFile] error: "
+            "unable to open file %s!\n", path.c_str());
+        exit(1);
+    }
+
+    unsigned char header[kBgzfHeaderSize + 6];
+    uint32_t header_length = fread(header, 1, sizeof(header), input);
+    fclose(input);
+
+    auto format = InputFile::Format::kPlain;
+    if (header_length >= 2 && header[0] == 31 && header[1] == 139) {
+        format = header_length == sizeof(header) &&
+            bgzfBlockSize(header, header + kBgzfHeaderSize, std::min<uint32_t>(
+                readLE(header + 10, 2), 6)) != 0 ?
+            InputFile::Format::kBgzf : InputFile::Format::kGzip;
+    }
+
+    return std::unique_ptr<InputFile>(new InputFile(path, format, thread_pool,
+        num_threads));
+}
+
+InputFile::InputFile(const std::string& path, Format format,
+    thread_pool::ThreadPool* thread_pool, uint32_t num_threads)
+        : path_(path), format_(format), num_threads_(std::max(num_threads, 1U)),
+        pass_path_(path), pipe_(-1), is_canceled_(false), decompressor_(),
+        thread_pool_(thread_pool) {
+}
+
+InputFile::~InputFile() {
+    stop();
+}
+
+void InputFile::rewind() {
+
+    if (format_ == Format::kPlain) {
+        return;
+    }
+
+    stop();
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        fprintf(stderr, "[rala::InputFile::rewind] error: "
+            "unable to create pipe for file %s!\n", path_.c_str());
+        exit(1);
+    }
+#ifdef F_SETPIPE_SZ
+    fcntl(fds[1], F_SETPIPE_SZ, kBufferSize);
+#endif
+
+    pipe_ = fds[0];
+    pass_path_ = "/dev/fd/" + std::to_string(pipe_);
+    is_canceled_ = false;
+
+    decompressor_ = std::thread([this](int fd) -> void {
+        if (format_ == Format::kBgzf) {
+            decompress_bgzf(fd);
+        } else {
+            decompress_gzip(fd);
+        }
+        close(fd);
+    }, fds[1]);
+}
+
+void InputFile::stop() {
+
+    if (!decompressor_.joinable()) {
+        return;
+    }
+
+    // drain the pipe so that the decompressor notices the cancellation
+    is_canceled_ = true;
+    std::vector<char> buffer(kBufferSize);
+    while (true) {
+        auto num_bytes = read(pipe_, buffer.data(), buffer.size());
+        if (num_bytes == 0 || (num_bytes < 0 && errno != EINTR)) {
+            break;
+        }
+    }
+
+    decompressor_.join();
+    close(pipe_);
+    pipe_ = -1;
+    pass_path_ = path_;
+}
+
+bool InputFile::write(int fd, const std::vector<char>& data) {
+
+    uint64_t num_written_bytes = 0;
+    while (num_written_bytes < data.size()) {
+        if (is_canceled_) {
+            return false;
+        }
+        auto num_bytes = ::write(fd, data.data() + num_written_bytes,
+            data.size() - num_written_bytes);
+        if (num_bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "[rala::InputFile::write] error: "
+                "unable to stream file %s!\n", path_.c_str());
+            exit(1);
+        }
+        num_written_bytes += num_bytes;
+    }
+
+    return !is_canceled_;
+}
+
+void InputFile::decompress_gzip(int fd) {
+
+    gzFile input = gzopen(path_.c_str(), "rb");
+    if (input == nullptr) {
+        fprintf(stderr, "[rala::InputFile::decompress_gzip] error: "
+            "unable to open file %s!\n", path_.c_str());
+        exit(1);
+    }
+    gzbuffer(input, kBufferSize);
+
+    std::vector<char> buffer;
+    while (true) {
+        buffer.resize(kBufferSize);
+        int num_bytes = gzread(input, buffer.data(), buffer.size());
+        if (num_bytes < 0) {
+            fprintf(stderr, "[rala::InputFile::decompress_gzip] error: "
+                "unable to decompress file %s!\n", path_.c_str());
+            exit(1);
+        }
+        if (num_bytes == 0) {
+            break;
+        }
+        buffer.resize(num_bytes);
+        if (!write(fd, buffer)) {
+            break;
+        }
+    }
+
+    gzclose(input);
+}
+
+void InputFile::decompress_bgzf(int fd) {
+
+    FILE* input = fopen(path_.c_str(), "rb");
+    if (input == nullptr) {
+        fprintf(stderr, "[rala::InputFile::decompress_bgzf] error: "
+            "unable to open file %s!\n", path_.c_str());
+        exit(1);
+    }
+
+    // batches of blocks are inflated in parallel and written in order
+    std::deque<std::future<std::vector<char>>> batches;
+    bool is_written = true;
+
+    auto write_batch = [&]() -> void {
+        auto data = batches.front().get();
+        batches.pop_front();
+        is_written = is_written && write(fd, data);
+    };
+
+    bool is_eof = false;
+    while (!is_eof && is_written) {
+        std::vector<unsigned char> blocks;
+        std::vector<uint32_t> offsets(1, 0);
+
+        while (offsets.size() <= kBgzfBatchSize) {
+            unsigned char header[kBgzfHeaderSize];
+            uint32_t header_length = fread(header, 1, kBgzfHeaderSize, input);
+            if (header_length == 0) {
+                is_eof = true;
+                break;
+            }
+
+            uint32_t extra_length = header_length == kBgzfHeaderSize ?
+                readLE(header + 10, 2) : 0;
+            std::vector<unsigned char> extra(extra_length);
+            uint32_t block_size = header_length == kBgzfHeaderSize &&
+                fread(extra.data(), 1, extra_length, input) == extra_length ?
+                bgzfBlockSize(header, extra.data(), extra_length) : 0;
+
+            if (block_size < kBgzfHeaderSize + extra_length + 8) {
+                fprintf(stderr, "[rala::InputFile::decompress_bgzf] error: "
+                    "invalid block in file %s!\n", path_.c_str());
+                exit(1);
+            }
+
+            uint64_t block_begin = blocks.size();
+            blocks.resize(block_begin + block_size);
+            memcpy(&blocks[block_begin], header, kBgzfHeaderSize);
+            memcpy(&blocks[block_begin + kBgzfHeaderSize], extra.data(),
+                extra_length);
+
+            uint32_t data_length = block_size - kBgzfHeaderSize - extra_length;
+            if (fread(&blocks[block_begin + kBgzfHeaderSize + extra_length], 1,
+                data_length, input) != data_length) {
+
+                fprintf(stderr, "[rala::InputFile::decompress_bgzf] error: "
+                    "truncated file %s!\n", path_.c_str());
+                exit(1);
+            }
+            offsets.emplace_back(blocks.size());
+        }
+
+        if (offsets.size() > 1) {
+            batches.emplace_back(thread_pool_->submit_task(
+                [this](const std::vector<unsigned char>& blocks,
+                    const std::vector<uint32_t>& offsets) -> std::vector<char> {
+                    return bgzfInflate(blocks, offsets, path_);
+                }, std::move(blocks), std::move(offsets)));
+        }
+        if (batches.size() >= 2 * num_threads_) {
+            write_batch();
+        }
+    }
+    while (!batches.empty()) {
+        write_batch();
+    }
+
+    fclose(input);
+}
+
+}
@@ -0,0 +1,92 @@
+/*!
+ * @file input_file.hpp
+ *
+ * @brief InputFile class header file
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace thread_pool {
+    class ThreadPool;
+}
+
+namespace rala {
+
+class InputFile;
+std::unique_ptr<InputFile> createInputFile(const std::string& path,
+    thread_pool::ThreadPool* thread_pool, uint32_t num_threads);
+
+/*!
+ * @brief Provides the path from which a parser reads an input file in each
+ * pass; gzip compressed files are decompressed outside of the parser (BGZF
+ * blocks in parallel on thread_pool, which has to outlive the file, other
+ * gzip files on a dedicated thread) and streamed through a pipe, while
+ * uncompressed files are read directly
+ */
+class InputFile {
+public:
+    ~InputFile();
+
+    /*!
+     * @brief Returns the path which parsers should open in the current pass
+     */
+    const std::string& path() const {
+        return pass_path_;
+    }
+
+    /*!
+     * @brief Returns true if the file is read directly (byte offsets seen by
+     * parsers are offsets into the file itself)
+     */
+    bool is_plain() const {
+        return format_ == Format::kPlain;
+    }
+
+    /*!
+     * @brief Starts a new pass over decompressed data (an unfinished pass is
+     * discarded); a new parser has to be created afterwards
+     */
+    void rewind();
+
+    friend std::unique_ptr<InputFile> createInputFile(const std::string& path,
+        thread_pool::ThreadPool* thread_pool, uint32_t num_threads);
+private:
+    enum class Format {
+        kPlain,
+        kGzip,
+        kBgzf
+    };
+
+    InputFile(const std::string& path, Format format,
+        thread_pool::ThreadPool* thread_pool, uint32_t num_threads);
+    InputFile(const InputFile&) = delete;
+    const InputFile& operator=(const InputFile&) = delete;
+
+    void stop();
+
+    void decompress_gzip(int fd);
+    void decompress_bgzf(int fd);
+
+    /*!
+     * @brief Writes data to the pipe; returns false if the pass was discarded
+     */
+    bool write(int fd, const std::vector<char>& data);
+
+    std::string path_;
+    Format format_;
+    uint32_t num_threads_;
+    std::string pass_path_;
+    int pipe_;
+    std::atomic<bool> is_canceled_;
+    std::thread decompressor_;
+    thread_pool::ThreadPool* thread_pool_;
+};
+
+}
@@ -1,8 +1,9 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <getopt.h>
 
-#include "sequence.hpp"
+#include "output_file.hpp"
 #include "graph.hpp"
 #include "thread_pool/thread_pool.hpp"
 
@@ -12,6 +13,15 @@ static struct option options[] = {
     {"include-unassembled", no_argument, 0, 'u'},
     {"mcl-group", required_argument, 0, 'm'},
     {"debug", required_argument, 0, 'd'},
+    {"store-size", required_argument, 0, 's'},
+    {"no-cache", no_argument, 0, 'n'},
+    {"low-memory", no_argument, 0, 'l'},
+    {"output", required_argument, 0, 'o'},
+    {"line-width", required_argument, 0, 'w'},
+    {"compress", required_argument, 0, 'c'},
+    {"gfa", required_argument, 0, 'g'},
+    {"gfa-stages", required_argument, 0, 'G'},
+    {"gfa-separate-sequences", no_argument, 0, 'S'},
     {"threads", required_argument, 0, 't'},
     {"version", no_argument, 0, 'v'},
     {"help", no_argument, 0, 'h'},
@@ -26,9 +36,18 @@ int main(int argc, char** argv) {
     int32_t mcl_group = -1;
     bool drop_unassembled_sequences = true;
     std::string debug_prefix = "";
+    uint64_t max_store_size = 4096;
+    bool use_overlap_cache = true;
+    bool compress_piles = false;
+    std::string output_path = "";
+    uint32_t line_width = 0;
+    auto compression = rala::Compression::kNone;
+    std::string gfa_path = "";
+    std::string gfa_prefix = "";
+    bool is_gfa_sequence_separate = false;
 
     char opt;
-    while ((opt = getopt_long(argc, argv, "ud:t:h:m:", options, nullptr)) != -1) {
+    while ((opt = getopt_long(argc, argv, "ud:s:o:t:h:m:", options, nullptr)) != -1) {
         switch (opt) {
             case 'u':
                 drop_unassembled_sequences = false;
@@ -39,6 +58,41 @@ int main(int argc, char** argv) {
             case 'd':
                 debug_prefix = optarg;
                 break;
+            case 's':
+                max_store_size = atoll(optarg);
+                break;
+            case 'n':
+                use_overlap_cache = false;
+                break;
+            case 'l':
+                compress_piles = true;
+                break;
+            case 'o':
+                output_path = optarg;
+                break;
+            case 'w':
+                line_width = atoi(optarg);
+                break;
+            case 'c':
+                if (strcmp(optarg, "gzip") == 0) {
+                    compression = rala::Compression::kGzip;
+                } else if (strcmp(optarg, "bgzf") == 0) {
+                    compression = rala::Compression::kBgzf;
+                } else {
+                    fprintf(stderr, "[rala::] error: "
+                        "unknown compression %s!\n", optarg);
+                    exit(1);
+                }
+                break;
+            case 'g':
+                gfa_path = optarg;
+                break;
+            case 'G':
+                gfa_prefix = optarg;
+                break;
+            case 'S':
+                is_gfa_sequence_separate = true;
+                break;
             case 't':
                 num_threads = atoi(optarg);
                 break;
@@ -67,18 +121,21 @@ int main(int argc, char** argv) {
 
     auto graph = rala::createGraph(
         input_paths[0], input_paths[1],
-        input_paths.size() == 3 ? input_paths[2] : "", mcl_group, num_threads
+        input_paths.size() == 3 ? input_paths[2] : "", mcl_group, num_threads,
+        max_store_size * 1024 * 1024, use_overlap_cache, compress_piles
     );
     graph->construct();
-    graph->simplify(debug_prefix);
+    graph->simplify(debug_prefix, gfa_prefix, is_gfa_sequence_separate);
 
-    std::vector<std::unique_ptr<rala::Sequence>> contigs;
-    graph->extract_contigs(contigs, drop_unassembled_sequences);
-
-    for (const auto& it: contigs) {
-        fprintf(stdout, "%s\n%s\n", it->name().c_str(), it->data().c_str());
+    if (!gfa_path.empty()) {
+        graph->print_gfa(gfa_path, is_gfa_sequence_separate);
     }
 
+    auto output = rala::createOutputFile(output_path, compression,
+        num_threads);
+    graph->write_contigs(output.get(), drop_unassembled_sequences, line_width);
+    output->close();
+
     return 0;
 }
 
@@ -100,6 +157,35 @@ void help() {
         "            enable debug output with given prefix\n"
         "        -m, --mcl-group <int>\n"
         "            build only this mcl group\n"
+        "        -s, --store-size <int>\n"
+        "            default: 4096\n"
+        "            memory budget (in MB) of the in-memory overlap store\n"
+        "            (overlaps are parsed only once if they fit, otherwise in\n"
+        "            each stage); 0 disables the store\n"
+        "        --no-cache\n"
+        "            do not create nor use the binary overlap cache\n"
+        "            (<overlaps>.rala) which speeds up reruns on the same input\n"
+        "        --low-memory\n"
+        "            store coverage piles as run-length segments (slower, but\n"
+        "            needs only a fraction of memory)\n"
+        "        -o, --output <string>\n"
+        "            default: stdout\n"
+        "            output file of contigs in FASTA format\n"
+        "        --line-width <int>\n"
+        "            default: 0\n"
+        "            wrap contig sequences into lines of given length\n"
+        "            (0 disables wrapping)\n"
+        "        --compress <string>\n"
+        "            compress output with gzip or bgzf (in parallel)\n"
+        "        --gfa <string>\n"
+        "            output file of the assembly graph in GFA format\n"
+        "        --gfa-stages <string>\n"
+        "            print the assembly graph in GFA format before and after\n"
+        "            each simplification stage into files with given prefix\n"
+        "        --gfa-separate-sequences\n"
+        "            write '*' instead of segment sequences in GFA files and\n"
+        "            store the sequences into FASTA files (.gfa is replaced\n"
+        "            with .fasta)\n"
         "        -t, --threads <int>\n"
         "            default: 1\n"
         "            number of threads\n"
@@ -0,0 +1,58 @@
+/*!
+ * @file mapped_file.cpp
+ *
+ * @brief MappedFile class source file
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "mapped_file.hpp"
+
+namespace rala {
+
+std::unique_ptr<MappedFile> createMappedFile(const std::string& path,
+    bool is_sequential) {
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return nullptr;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+        close(fd);
+        return nullptr;
+    }
+
+    uint64_t size = file_stat.st_size;
+    void* data = nullptr;
+    if (size > 0) {
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    if (data != nullptr) {
+        madvise(data, size, is_sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    }
+
+    return std::unique_ptr<MappedFile>(new MappedFile(
+        static_cast<const char*>(data), size));
+}
+
+MappedFile::MappedFile(const char* data, uint64_t size)
+        : data_(data), size_(size) {
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+}
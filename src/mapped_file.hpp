@@ -0,0 +1,75 @@
+/*!
+ * @file mapped_file.hpp
+ *
+ * @brief MappedFile class header file
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rala {
+
+class MappedFile;
+std::unique_ptr<MappedFile> createMappedFile(const std::string& path,
+    bool is_sequential);
+
+/*!
+ * @brief Read-only memory mapping of a whole (uncompressed) file so that
+ * parsers can work on slices of it without copying; the kernel is advised
+ * whether the file is going to be read sequentially or randomly
+ */
+class MappedFile {
+public:
+    ~MappedFile();
+
+    const char* data() const {
+        return data_;
+    }
+
+    uint64_t size() const {
+        return size_;
+    }
+
+    /*!
+     * @brief Splits [begin, end> into at most num_parts ranges of similar
+     * size; each part (but the first) begins at a position for which
+     * is_boundary() returns true, found by scanning forward from its ideal
+     * split point (parts which would be empty are merged into previous ones);
+     * returns part offsets including begin and end
+     */
+    template<typename F>
+    std::vector<uint64_t> split(uint64_t begin, uint64_t end,
+        uint32_t num_parts, const F& is_boundary) const {
+
+        std::vector<uint64_t> offsets(1, begin);
+        for (uint32_t i = 1; i < num_parts; ++i) {
+            uint64_t j = std::max(offsets.back(),
+                begin + (end - begin) * i / num_parts);
+            while (j < end && !is_boundary(j)) {
+                ++j;
+            }
+            if (j > offsets.back() && j < end) {
+                offsets.emplace_back(j);
+            }
+        }
+        offsets.emplace_back(end);
+        return offsets;
+    }
+
+    friend std::unique_ptr<MappedFile> createMappedFile(const std::string& path,
+        bool is_sequential);
+private:
+    MappedFile(const char* data, uint64_t size);
+    MappedFile(const MappedFile&) = delete;
+    const MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data_;
+    uint64_t size_;
+};
+
+}
@@ -0,0 +1,89 @@
+/*!
+ * @file name_table.cpp
+ *
+ * @brief NameTable class source file
+ */
+
+#include <string.h>
+
+#include "name_table.hpp"
+
+namespace rala {
+
+constexpr uint64_t NameTable::kNotFound;
+
+constexpr uint64_t kMinNumSlots = 1024;
+
+uint64_t nameHash(const char* name, uint32_t name_length) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint32_t i = 0; i < name_length; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(name[i])) * 1099511628211ULL;
+    }
+    return hash ^ (hash >> 32);
+}
+
+NameTable::NameTable()
+        : names_(), offsets_(1, 0), slots_(kMinNumSlots, 0), num_interned_(0) {
+}
+
+uint64_t NameTable::find_slot(const char* name, uint32_t name_length,
+    uint64_t hash) const {
+
+    uint64_t mask = slots_.size() - 1;
+    for (uint64_t i = hash & mask;; i = (i + 1) & mask) {
+        if (slots_[i] == 0) {
+            return i;
+        }
+        uint64_t id = slots_[i] - 1;
+        if (offsets_[id + 1] - offsets_[id] == name_length &&
+            memcmp(names_.data() + offsets_[id], name, name_length) == 0) {
+            return i;
+        }
+    }
+}
+
+void NameTable::rehash(uint64_t num_slots) {
+
+    std::vector<uint64_t> slots(num_slots, 0);
+    slots_.swap(slots);
+
+    for (const auto& it: slots) {
+        if (it == 0) {
+            continue;
+        }
+        uint64_t id = it - 1;
+        const char* name = names_.data() + offsets_[id];
+        uint32_t name_length = offsets_[id + 1] - offsets_[id];
+        slots_[find_slot(name, name_length, nameHash(name, name_length))] = it;
+    }
+}
+
+void NameTable::add(const char* name, uint32_t name_length) {
+
+    // load factor is kept at most 1/2
+    if (2 * (num_interned_ + 1) > slots_.size()) {
+        rehash(2 * slots_.size());
+    }
+
+    // bytes are stored first so that find_slot() can compare against them
+    names_.insert(names_.end(), name, name + name_length);
+    offsets_.emplace_back(names_.size());
+
+    uint64_t slot = find_slot(name, name_length, nameHash(name, name_length));
+    if (slots_[slot] == 0) {
+        ++num_interned_;
+    }
+    slots_[slot] = size();
+}
+
+uint64_t NameTable::find(const char* name, uint32_t name_length) const {
+    uint64_t slot = find_slot(name, name_length, nameHash(name, name_length));
+    return slots_[slot] == 0 ? kNotFound : slots_[slot] - 1;
+}
+
+void NameTable::shrink_to_fit() {
+    names_.shrink_to_fit();
+    offsets_.shrink_to_fit();
+}
+
+}
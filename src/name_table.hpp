@@ -0,0 +1,75 @@
+/*!
+ * @file name_table.hpp
+ *
+ * @brief NameTable class header file
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace rala {
+
+/*!
+ * @brief Interned sequence names; name bytes are stored back to back in one
+ * array and names are looked up by their bytes through a flat open addressing
+ * hash table of ids (linear probing), so that no strings have to be created;
+ * lookups are thread safe as long as no names are being added
+ */
+class NameTable {
+public:
+    NameTable();
+    ~NameTable() = default;
+
+    uint64_t size() const {
+        return offsets_.size() - 1;
+    }
+
+    /*!
+     * @brief Interns name under id size(); if the name was already interned,
+     * its lookups return the new id from now on
+     */
+    void add(const char* name, uint32_t name_length);
+
+    /*!
+     * @brief Returns the name interned under id
+     */
+    std::string name(uint64_t id) const {
+        return std::string(names_.data() + offsets_[id],
+            offsets_[id + 1] - offsets_[id]);
+    }
+
+    /*!
+     * @brief Returns the id of name or kNotFound if it was not interned
+     */
+    uint64_t find(const char* name, uint32_t name_length) const;
+
+    /*!
+     * @brief Releases excess capacity once all names are added
+     */
+    void shrink_to_fit();
+
+    static constexpr uint64_t kNotFound = UINT64_MAX;
+
+private:
+    NameTable(const NameTable&) = delete;
+    const NameTable& operator=(const NameTable&) = delete;
+
+    /*!
+     * @brief Returns the slot which holds name or the empty slot where it
+     * belongs
+     */
+    uint64_t find_slot(const char* name, uint32_t name_length,
+        uint64_t hash) const;
+
+    void rehash(uint64_t num_slots);
+
+    std::vector<char> names_;
+    std::vector<uint64_t> offsets_; // name i spans [offsets_[i], offsets_[i + 1]>
+    std::vector<uint64_t> slots_; // id + 1, or 0 if empty
+    uint64_t num_interned_;
+};
+
+}
@@ -0,0 +1,208 @@
+/*!
+ * @file output_file.cpp
+ *
+ * @brief OutputFile class source file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <zlib.h>
+
+#include "output_file.hpp"
+
+#include "thread_pool/thread_pool.hpp"
+
+namespace rala {
+
+constexpr uint32_t kBgzfBlockSize = 0xff00; // uncompressed bytes per block
+constexpr uint32_t kBgzfHeaderSize = 18;
+constexpr uint32_t kBgzfFooterSize = 8;
+constexpr uint32_t kBgzfMaxBlockSize = 65536;
+
+constexpr unsigned char kBgzfEof[28] = {
+    31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0, 27, 0, 3, 0,
+    0, 0, 0, 0, 0, 0, 0, 0
+};
+
+void writeLE(unsigned char* dst, uint32_t value, uint32_t num_bytes) {
+    for (uint32_t i = 0; i < num_bytes; ++i) {
+        dst[i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+/*!
+ * @brief Compresses src into a single gzip member or, if is_bgzf is set, into
+ * consecutive BGZF blocks (gzip members with the BC extra subfield holding
+ * the block size)
+ */
+std::vector<char> gzipDeflate(const std::vector<char>& src, bool is_bgzf,
+    const std::string& path) {
+
+    std::vector<char> dst;
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    bool is_valid = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+        is_bgzf ? -15 : 31, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+
+    uint64_t block_size = is_bgzf ? kBgzfBlockSize : src.size();
+    for (uint64_t i = 0; is_valid && i < src.size(); i += block_size) {
+
+        uint64_t size = std::min(block_size, src.size() - i);
+        uint64_t header_size = is_bgzf ? kBgzfHeaderSize : 0;
+        uint64_t bound = deflateBound(&stream, size);
+
+        uint64_t block_begin = dst.size();
+        dst.resize(block_begin + header_size + bound + kBgzfFooterSize);
+        auto block = reinterpret_cast<unsigned char*>(&dst[block_begin]);
+
+        stream.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(
+            src.data() + i));
+        stream.avail_in = size;
+        stream.next_out = block + header_size;
+        stream.avail_out = bound;
+
+        is_valid = deflate(&stream, Z_FINISH) == Z_STREAM_END &&
+            deflateReset(&stream) == Z_OK;
+        uint64_t data_size = bound - stream.avail_out;
+
+        if (!is_bgzf) {
+            dst.resize(block_begin + data_size);
+            continue;
+        }
+
+        uint64_t total_size = header_size + data_size + kBgzfFooterSize;
+        is_valid = is_valid && total_size <= kBgzfMaxBlockSize;
+
+        unsigned char header[kBgzfHeaderSize] = {
+            31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0, 0, 0
+        };
+        writeLE(header + 16, total_size - 1, 2);
+        memcpy(block, header, kBgzfHeaderSize);
+
+        unsigned char* footer = block + header_size + data_size;
+        writeLE(footer, crc32(crc32(0, nullptr, 0), reinterpret_cast<const
+            unsigned char*>(src.data() + i), size), 4);
+        writeLE(footer + 4, size, 4);
+
+        dst.resize(block_begin + total_size);
+    }
+    deflateEnd(&stream);
+
+    if (!is_valid) {
+        fprintf(stderr, "[rala::OutputFile::flush_batch] error: "
+            "unable to compress file %s!\n", path.c_str());
+        exit(1);
+    }
+
+    return dst;
+}
+
+std::unique_ptr<OutputFile> createOutputFile(const std::string& path,
+    Compression compression, uint32_t num_threads) {
+
+    if (path.empty() || path == "-") {
+        return std::unique_ptr<OutputFile>(new OutputFile("stdout",
+            STDOUT_FILENO, compression, num_threads));
+    }
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "[rala::createOutputFile] error: "
+            "unable to create file %s!\n", path.c_str());
+        exit(1);
+    }
+
+    return std::unique_ptr<OutputFile>(new OutputFile(path, fd, compression,
+        num_threads));
+}
+
+OutputFile::OutputFile(const std::string& path, int fd,
+    Compression compression, uint32_t num_threads)
+        : path_(path), fd_(fd), compression_(compression),
+        num_threads_(std::max(num_threads, 1U)), buffer_(), batches_(),
+        thread_pool_() {
+
+    buffer_.reserve(kBatchSize);
+    if (compression_ != Compression::kNone) {
+        thread_pool_ = thread_pool::createThreadPool(num_threads_);
+    }
+}
+
+OutputFile::~OutputFile() {
+    close();
+}
+
+void OutputFile::write_batch(const std::vector<char>& data) {
+
+    uint64_t num_written_bytes = 0;
+    while (num_written_bytes < data.size()) {
+        auto num_bytes = ::write(fd_, data.data() + num_written_bytes,
+            data.size() - num_written_bytes);
+        if (num_bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "[rala::OutputFile::write_batch] error: "
+                "unable to write file %s!\n", path_.c_str());
+            exit(1);
+        }
+        num_written_bytes += num_bytes;
+    }
+}
+
+void OutputFile::flush_batch() {
+
+    if (buffer_.empty()) {
+        return;
+    }
+
+    if (compression_ == Compression::kNone) {
+        write_batch(buffer_);
+        buffer_.clear();
+        return;
+    }
+
+    batches_.emplace_back(thread_pool_->submit_task(
+        [this](const std::vector<char>& data) -> std::vector<char> {
+            return gzipDeflate(data, compression_ == Compression::kBgzf, path_);
+        }, std::move(buffer_)));
+
+    buffer_ = std::vector<char>();
+    buffer_.reserve(kBatchSize);
+
+    while (batches_.size() >= 2 * num_threads_) {
+        write_batch(batches_.front().get());
+        batches_.pop_front();
+    }
+}
+
+void OutputFile::close() {
+
+    if (fd_ == -1) {
+        return;
+    }
+
+    flush_batch();
+    while (!batches_.empty()) {
+        write_batch(batches_.front().get());
+        batches_.pop_front();
+    }
+    if (compression_ == Compression::kBgzf) {
+        write_batch(std::vector<char>(kBgzfEof, kBgzfEof + sizeof(kBgzfEof)));
+    }
+
+    if (fd_ != STDOUT_FILENO && ::close(fd_) != 0) {
+        fprintf(stderr, "[rala::OutputFile::close] error: "
+            "unable to write file %s!\n", path_.c_str());
+        exit(1);
+    }
+    fd_ = -1;
+}
+
+}
@@ -0,0 +1,90 @@
+/*!
+ * @file output_file.hpp
+ *
+ * @brief OutputFile class header file
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace thread_pool {
+    class ThreadPool;
+}
+
+namespace rala {
+
+enum class Compression {
+    kNone,
+    kGzip, // concatenated gzip members
+    kBgzf
+};
+
+class OutputFile;
+std::unique_ptr<OutputFile> createOutputFile(const std::string& path,
+    Compression compression, uint32_t num_threads);
+
+/*!
+ * @brief Buffered writer of an output file (or of stdout if the path is empty
+ * or "-"); data is written in large batches which are, if the file is
+ * compressed, deflated in parallel on a dedicated thread pool and written in
+ * order (each batch becomes a gzip member or a run of BGZF blocks)
+ */
+class OutputFile {
+public:
+    ~OutputFile();
+
+    const std::string& path() const {
+        return path_;
+    }
+
+    void write(const char* data, uint64_t size) {
+        buffer_.insert(buffer_.end(), data, data + size);
+        if (buffer_.size() >= kBatchSize) {
+            flush_batch();
+        }
+    }
+
+    void write(const std::string& data) {
+        write(data.data(), data.size());
+    }
+
+    /*!
+     * @brief Writes all buffered data (and the BGZF end-of-file block) and
+     * closes the file; called by the destructor if needed
+     */
+    void close();
+
+    friend std::unique_ptr<OutputFile> createOutputFile(const std::string& path,
+        Compression compression, uint32_t num_threads);
+private:
+    static constexpr uint32_t kBatchSize = 64 * 0xff00; // 64 BGZF blocks
+
+    OutputFile(const std::string& path, int fd, Compression compression,
+        uint32_t num_threads);
+    OutputFile(const OutputFile&) = delete;
+    const OutputFile& operator=(const OutputFile&) = delete;
+
+    /*!
+     * @brief Passes the buffer to a worker (or writes it if the file is not
+     * compressed) and writes finished batches once enough of them queued up
+     */
+    void flush_batch();
+
+    void write_batch(const std::vector<char>& data);
+
+    std::string path_;
+    int fd_;
+    Compression compression_;
+    uint32_t num_threads_;
+    std::vector<char> buffer_;
+    std::deque<std::future<std::vector<char>>> batches_;
+    std::unique_ptr<thread_pool::ThreadPool> thread_pool_;
+};
+
+}
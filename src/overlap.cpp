@@ -4,6 +4,7 @@
  * @brief Overlap class header file
  */
 
+#include "name_table.hpp"
 #include "pile.hpp"
 #include "overlap.hpp"
 
@@ -23,31 +24,51 @@ Overlap::Overlap(const char* a_name, uint32_t a_name_length,
     uint32_t a_length, uint32_t a_begin, uint32_t a_end, char orientation,
     const char* b_name, uint32_t b_name_length, uint32_t b_length,
     uint32_t b_begin, uint32_t b_end, uint32_t, uint32_t overlap_length, uint32_t)
-        : a_name_(a_name, a_name_length), a_id_(), a_begin_(a_begin),
-        a_end_(a_end), a_length_(a_length), b_name_(b_name, b_name_length),
-        b_id_(), b_begin_(b_begin), b_end_(b_end), b_length_(b_length),
+        : a_name_(a_name, a_name_length), a_id_(NameTable::kNotFound),
+        a_begin_(a_begin), a_end_(a_end), a_length_(a_length),
+        b_name_(b_name, b_name_length), b_id_(NameTable::kNotFound),
+        b_begin_(b_begin), b_end_(b_end), b_length_(b_length),
         length_(overlap_length), orientation_(orientation == '+' ? 0 : 1),
         is_transmuted_(false) {
 }
 
+Overlap::Overlap(uint64_t a_id, uint32_t a_length, uint32_t a_begin,
+    uint32_t a_end, char orientation, uint64_t b_id, uint32_t b_length,
+    uint32_t b_begin, uint32_t b_end, uint32_t overlap_length)
+        : a_name_(), a_id_(a_id), a_begin_(a_begin), a_end_(a_end),
+        a_length_(a_length), b_name_(), b_id_(b_id), b_begin_(b_begin),
+        b_end_(b_end), b_length_(b_length), length_(overlap_length),
+        orientation_(orientation == '+' ? 0 : 1), is_transmuted_(false) {
+}
+
+Overlap::Overlap(uint32_t a_id, uint32_t a_begin, uint32_t a_end,
+    uint32_t a_length, uint32_t b_id, uint32_t b_begin, uint32_t b_end,
+    uint32_t b_length, uint32_t length, uint32_t orientation)
+        : a_name_(), a_id_(a_id), a_begin_(a_begin), a_end_(a_end),
+        a_length_(a_length), b_name_(), b_id_(b_id), b_begin_(b_begin),
+        b_end_(b_end), b_length_(b_length), length_(length),
+        orientation_(orientation), is_transmuted_(true) {
+}
+
 Overlap::~Overlap() {
 }
 
 bool Overlap::transmute(const std::vector<std::unique_ptr<Pile>>& piles,
-    const std::unordered_map<std::string, uint64_t>& name_to_id) {
+    const NameTable& names) {
 
     if (is_transmuted_) {
         return true;
     }
 
     if (!a_name_.empty()) {
-        auto it = name_to_id.find(a_name_);
-        if (it == name_to_id.end()) {
-            return false;
-        }
-        a_id_ = it->second;
+        a_id_ = names.find(a_name_.c_str(), a_name_.size());
         std::string().swap(a_name_);
     }
+    if (!b_name_.empty()) {
+        b_id_ = names.find(b_name_.c_str(), b_name_.size());
+        std::string().swap(b_name_);
+    }
+
     if (a_id_ >= piles.size() || piles[a_id_] == nullptr) {
         return false;
     }
@@ -58,15 +79,6 @@ bool Overlap::transmute(const std::vector<std::unique_ptr<Pile>>& piles,
         exit(1);
     }
 
-    if (!b_name_.empty()) {
-        auto it = name_to_id.find(b_name_);
-        if (it == name_to_id.end()) {
-            return false;
-        }
-        b_id_ = it->second;
-        std::string().swap(b_name_);
-    }
-
     if (b_id_ >= piles.size() || piles[b_id_] == nullptr) {
         return false;
     }
@@ -8,6 +8,8 @@
 
 #include <stdint.h>
 #include <memory>
+#include <string>
+#include <vector>
 #include <unordered_map>
 
 namespace bioparser {
@@ -21,6 +23,9 @@ namespace bioparser {
 namespace rala {
 
 class Pile;
+class NameTable;
+class OverlapStore;
+class PafReader;
 
 enum class OverlapType {
     kX, // bad overlap
@@ -74,8 +79,13 @@ public:
         return orientation_;
     }
 
+    /*!
+     * @brief Resolves sequence names (of PAF overlaps parsed by bioparser)
+     * to ids through names and checks whether both sequences exist and their
+     * lengths match; thread safe for distinct overlaps
+     */
     bool transmute(const std::vector<std::unique_ptr<Pile>>& piles,
-        const std::unordered_map<std::string, uint64_t>& name_to_id);
+        const NameTable& names);
 
     bool trim(const std::vector<std::unique_ptr<Pile>>& piles);
 
@@ -83,6 +93,8 @@ public:
 
     friend bioparser::MhapParser<Overlap>;
     friend bioparser::PafParser<Overlap>;
+    friend OverlapStore;
+    friend PafReader;
 private:
     Overlap(uint64_t a_id, uint64_t b_id, double error, uint32_t minmers,
         uint32_t a_rc, uint32_t a_begin, uint32_t a_end, uint32_t a_length,
@@ -92,6 +104,15 @@ private:
         char orientation, const char* b_name, uint32_t b_name_length,
         uint32_t b_length, uint32_t b_begin, uint32_t b_end,
         uint32_t matching_bases, uint32_t overlap_length, uint32_t quality);
+    // PAF overlap with names already resolved to ids (NameTable::kNotFound
+    // for unknown names)
+    Overlap(uint64_t a_id, uint32_t a_length, uint32_t a_begin,
+        uint32_t a_end, char orientation, uint64_t b_id, uint32_t b_length,
+        uint32_t b_begin, uint32_t b_end, uint32_t overlap_length);
+    // Transmuted overlap
+    Overlap(uint32_t a_id, uint32_t a_begin, uint32_t a_end, uint32_t a_length,
+        uint32_t b_id, uint32_t b_begin, uint32_t b_end, uint32_t b_length,
+        uint32_t length, uint32_t orientation);
     Overlap(const Overlap&) = delete;
     const Overlap& operator=(const Overlap&) = delete;
 
@@ -0,0 +1,234 @@
+/*!
+ * @file overlap_store.cpp
+ *
+ * @brief OverlapStore class source file
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#include "overlap.hpp"
+#include "overlap_store.hpp"
+
+namespace rala {
+
+constexpr char kCacheMagic[8] = "RALAOVL";
+constexpr uint32_t kCacheVersion = 1;
+
+std::unique_ptr<OverlapStore> createOverlapStore(uint64_t max_size,
+    const std::string& cache_path, uint64_t signature) {
+
+    if (max_size < sizeof(OverlapStore::Record) && cache_path.empty()) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<OverlapStore>(new OverlapStore(max_size, cache_path,
+        signature));
+}
+
+OverlapStore::OverlapStore(uint64_t max_size, const std::string& cache_path,
+    uint64_t signature)
+        : max_size_(max_size), cache_path_(cache_path), signature_(signature),
+        cache_file_(nullptr), mapped_data_(nullptr), mapped_size_(0),
+        is_memory_valid_(max_size >= sizeof(Record)), num_records_(0),
+        position_(0), records_() {
+
+    if (cache_path_.empty() || map_cache()) {
+        return;
+    }
+
+    cache_file_ = fopen((cache_path_ + ".tmp").c_str(), "wb");
+    if (cache_file_ == nullptr) {
+        fprintf(stderr, "[rala::OverlapStore::OverlapStore] warning: "
+            "unable to create overlap cache %s!\n", cache_path_.c_str());
+        return;
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    if (fwrite(&header, sizeof(header), 1, cache_file_) != 1) {
+        close_cache(false);
+    }
+}
+
+OverlapStore::~OverlapStore() {
+    if (cache_file_ != nullptr) {
+        close_cache(false);
+    }
+    unmap_cache();
+}
+
+bool OverlapStore::store(const std::unique_ptr<Overlap>& overlap,
+    bool is_valid) {
+
+    if (is_cached()) {
+        fprintf(stderr, "[rala::OverlapStore::store] error: "
+            "store is read-only!\n");
+        exit(1);
+    }
+    Record record;
+    record.a_id = overlap->a_id();
+    record.a_begin = overlap->a_begin();
+    record.a_end = overlap->a_end();
+    record.a_length = overlap->a_length();
+    record.b_id = overlap->b_id();
+    record.b_begin = overlap->b_begin();
+    record.b_end = overlap->b_end();
+    record.b_length = overlap->b_length();
+    record.length = overlap->length();
+    record.flags = (overlap->orientation() & 1) | (is_valid ? 2 : 0);
+
+    if (is_memory_valid_) {
+        uint64_t max_records = max_size_ / sizeof(Record);
+        if (records_.size() == max_records) {
+            is_memory_valid_ = false;
+            std::vector<Record>().swap(records_);
+        } else {
+            if (records_.size() == records_.capacity()) {
+                records_.reserve(std::min(max_records,
+                    std::max<uint64_t>(1024, records_.capacity() * 2)));
+            }
+            records_.emplace_back(record);
+        }
+    }
+
+    if (cache_file_ != nullptr &&
+        fwrite(&record, sizeof(record), 1, cache_file_) != 1) {
+
+        fprintf(stderr, "[rala::OverlapStore::store] warning: "
+            "unable to write overlap cache %s!\n", cache_path_.c_str());
+        close_cache(false);
+    }
+
+    ++num_records_;
+
+    return is_memory_valid_ || cache_file_ != nullptr;
+}
+
+bool OverlapStore::finalize() {
+
+    if (is_cached()) {
+        return true;
+    }
+
+    if (cache_file_ != nullptr) {
+        close_cache(true);
+    }
+    if (is_memory_valid_) {
+        return true;
+    }
+
+    return map_cache();
+}
+
+void OverlapStore::close_cache(bool is_valid) {
+
+    std::string tmp_path = cache_path_ + ".tmp";
+
+    if (is_valid) {
+        Header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, kCacheMagic, sizeof(header.magic));
+        header.version = kCacheVersion;
+        header.record_size = sizeof(Record);
+        header.signature = signature_;
+        header.num_records = num_records_;
+
+        is_valid = fseek(cache_file_, 0, SEEK_SET) == 0 &&
+            fwrite(&header, sizeof(header), 1, cache_file_) == 1;
+    }
+    is_valid &= fclose(cache_file_) == 0;
+    cache_file_ = nullptr;
+
+    if (!is_valid || rename(tmp_path.c_str(), cache_path_.c_str()) != 0) {
+        if (is_valid) {
+            fprintf(stderr, "[rala::OverlapStore::close_cache] warning: "
+                "unable to create overlap cache %s!\n", cache_path_.c_str());
+        }
+        remove(tmp_path.c_str());
+    }
+}
+
+bool OverlapStore::map_cache() {
+
+    int fd = open(cache_path_.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 ||
+        static_cast<uint64_t>(file_stat.st_size) < sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+
+    mapped_size_ = file_stat.st_size;
+    void* data = mmap(nullptr, mapped_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        mapped_size_ = 0;
+        return false;
+    }
+    mapped_data_ = static_cast<const char*>(data);
+
+    const Header* header = reinterpret_cast<const Header*>(mapped_data_);
+    if (memcmp(header->magic, kCacheMagic, sizeof(header->magic)) != 0 ||
+        header->version != kCacheVersion ||
+        header->record_size != sizeof(Record) ||
+        header->signature != signature_ ||
+        mapped_size_ != sizeof(Header) + header->num_records * sizeof(Record)) {
+
+        unmap_cache();
+        return false;
+    }
+
+    madvise(data, mapped_size_, MADV_SEQUENTIAL);
+
+    num_records_ = header->num_records;
+    std::vector<Record>().swap(records_);
+    is_memory_valid_ = false;
+
+    return true;
+}
+
+void OverlapStore::unmap_cache() {
+    if (mapped_data_ != nullptr) {
+        munmap(const_cast<char*>(mapped_data_), mapped_size_);
+        mapped_data_ = nullptr;
+        mapped_size_ = 0;
+    }
+}
+
+void OverlapStore::reset() {
+    position_ = 0;
+}
+
+bool OverlapStore::load(std::vector<std::unique_ptr<Overlap>>& dst,
+    uint64_t max_bytes, bool valid_only) {
+
+    const Record* data = records();
+
+    uint64_t num_records = std::max<uint64_t>(1, max_bytes / sizeof(Record));
+    uint64_t end = std::min<uint64_t>(num_records_, position_ + num_records);
+
+    for (; position_ < end; ++position_) {
+        const auto& it = data[position_];
+        if (valid_only && !(it.flags & 2)) {
+            continue;
+        }
+        dst.emplace_back(new Overlap(it.a_id, it.a_begin, it.a_end,
+            it.a_length, it.b_id, it.b_begin, it.b_end, it.b_length,
+            it.length, it.flags & 1));
+    }
+
+    return position_ < num_records_;
+}
+
+}
@@ -0,0 +1,122 @@
+/*!
+ * @file overlap_store.hpp
+ *
+ * @brief OverlapStore class header file
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rala {
+
+class Overlap;
+
+class OverlapStore;
+std::unique_ptr<OverlapStore> createOverlapStore(uint64_t max_size,
+    const std::string& cache_path, uint64_t signature);
+
+/*!
+ * @brief Keeps transmuted overlaps in a compact fixed-width format so that the
+ * overlap file has to be parsed only once; overlaps can additionally be
+ * written to a binary cache file which is memory-mapped by later runs with the
+ * same signature (cache layout is a 32-byte header followed by records)
+ */
+class OverlapStore {
+public:
+    ~OverlapStore();
+
+    uint64_t size() const {
+        return num_records_;
+    }
+
+    /*!
+     * @brief Returns true if overlaps were mapped from a cache file created by
+     * a previous run (no overlaps need to be stored)
+     */
+    bool is_cached() const {
+        return mapped_data_ != nullptr;
+    }
+
+    /*!
+     * @brief Appends a transmuted overlap and its validity to the store;
+     * in-memory records are dropped once they exceed max_size_ bytes and
+     * only the cache file is written afterwards; if there is no cache file to
+     * fall back to, false is returned
+     */
+    bool store(const std::unique_ptr<Overlap>& overlap, bool is_valid);
+
+    /*!
+     * @brief Completes the cache file and maps it if in-memory records were
+     * dropped; returns false if the store does not hold all overlaps
+     */
+    bool finalize();
+
+    /*!
+     * @brief Rewinds the store so that load() starts from the first overlap
+     */
+    void reset();
+
+    /*!
+     * @brief Materializes up to max_bytes worth of stored overlaps into dst
+     * (skipping invalid ones if valid_only is set); returns false if there
+     * are no more overlaps to load (same as bioparser::Parser::parse_objects)
+     */
+    bool load(std::vector<std::unique_ptr<Overlap>>& dst, uint64_t max_bytes,
+        bool valid_only);
+
+    friend std::unique_ptr<OverlapStore> createOverlapStore(uint64_t max_size,
+        const std::string& cache_path, uint64_t signature);
+private:
+    OverlapStore(uint64_t max_size, const std::string& cache_path,
+        uint64_t signature);
+    OverlapStore(const OverlapStore&) = delete;
+    const OverlapStore& operator=(const OverlapStore&) = delete;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_size;
+        uint64_t signature;
+        uint64_t num_records;
+    };
+
+    struct Record {
+        uint32_t a_id;
+        uint32_t a_begin;
+        uint32_t a_end;
+        uint32_t a_length;
+        uint32_t b_id;
+        uint32_t b_begin;
+        uint32_t b_end;
+        uint32_t b_length;
+        uint32_t length;
+        uint32_t flags; // orientation (bit 0), validity (bit 1)
+    };
+
+    const Record* records() const {
+        return mapped_data_ != nullptr ? reinterpret_cast<const Record*>(
+            mapped_data_ + sizeof(Header)) : records_.data();
+    }
+
+    bool map_cache();
+    void unmap_cache();
+    void close_cache(bool is_valid);
+
+    uint64_t max_size_;
+    std::string cache_path_;
+    uint64_t signature_;
+    FILE* cache_file_;
+    const char* mapped_data_;
+    uint64_t mapped_size_;
+    bool is_memory_valid_;
+    uint64_t num_records_;
+    uint64_t position_;
+    std::vector<Record> records_;
+};
+
+}
@@ -0,0 +1,199 @@
+/*!
+ * @file packed_sequence.cpp
+ *
+ * @brief PackedSequence class source file
+ */
+
+#include <algorithm>
+
+#include "packed_sequence.hpp"
+
+namespace rala {
+
+constexpr char kBases[] = "ACGT";
+
+int32_t baseCode(char base) {
+    switch (base) {
+        case 'A': return 0;
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': return 3;
+        default: return -1;
+    }
+}
+
+PackedSequence::PackedSequence()
+        : size_(0), words_(), exceptions_() {
+}
+
+PackedSequence::PackedSequence(const char* data, uint32_t data_length)
+        : PackedSequence() {
+
+    words_.reserve((data_length + 31) / 32);
+    for (uint32_t i = 0; i < data_length; ++i) {
+        int32_t c = baseCode(data[i]);
+        if (c != -1) {
+            push_back(c);
+            continue;
+        }
+        c = baseCode(data[i] - ('a' - 'A'));
+        bool is_lowercase = c != -1;
+        push_back(is_lowercase ? c : 0);
+        push_back_exception(data[i], is_lowercase);
+    }
+}
+
+PackedSequence::PackedSequence(const std::string& data)
+        : PackedSequence(data.c_str(), data.size()) {
+}
+
+void PackedSequence::push_back(uint32_t code) {
+    if ((size_ & 31) == 0) {
+        words_.emplace_back(0);
+    }
+    words_.back() |= static_cast<uint64_t>(code) << ((size_ & 31) << 1);
+    ++size_;
+}
+
+void PackedSequence::push_back_exception(char base, bool is_lowercase) {
+
+    uint32_t position = size_ - 1;
+    if (!exceptions_.empty()) {
+        auto& last = exceptions_.back();
+        if (last.begin + last.length == position &&
+            last.is_lowercase == is_lowercase &&
+            (is_lowercase || last.base == base)) {
+            ++last.length;
+            return;
+        }
+    }
+    exceptions_.push_back({position, 1, is_lowercase ? '\0' : base,
+        is_lowercase});
+}
+
+char PackedSequence::base(const Exception& exception, uint32_t i) const {
+    return exception.is_lowercase ? kBases[code(i)] + ('a' - 'A') :
+        exception.base;
+}
+
+template<typename T>
+void PackedSequence::visit(uint32_t begin, uint32_t length,
+    bool is_reverse_complement, const T& function) const {
+
+    if (!is_reverse_complement) {
+        uint32_t end = begin + length;
+        // first run ending after begin
+        auto exception = std::upper_bound(exceptions_.begin(),
+            exceptions_.end(), begin, [](uint32_t position,
+                const Exception& run) -> bool {
+                return position < run.begin + run.length;
+            });
+        for (uint32_t i = begin; i < end; ++exception) {
+            uint32_t run_begin = exception == exceptions_.end() ? end :
+                std::min(std::max(exception->begin, i), end);
+            for (; i < run_begin; ++i) {
+                function(i, nullptr);
+            }
+            if (i == end) {
+                break;
+            }
+            uint32_t run_end = std::min(exception->begin + exception->length,
+                end);
+            for (; i < run_end; ++i) {
+                function(i, &*exception);
+            }
+        }
+        return;
+    }
+
+    // forward positions [begin, end> are visited backwards, exception points
+    // one past the last candidate run
+    uint32_t end = size_ - begin;
+    begin = end - length;
+    auto exception = std::lower_bound(exceptions_.begin(), exceptions_.end(),
+        end, [](const Exception& run, uint32_t position) -> bool {
+            return run.begin < position;
+        });
+    for (uint32_t i = end; i > begin; --exception) {
+        uint32_t run_end = exception == exceptions_.begin() ? begin :
+            std::max(std::min((exception - 1)->begin + (exception - 1)->length,
+            i), begin);
+        for (; i > run_end; --i) {
+            function(i - 1, nullptr);
+        }
+        if (i == begin) {
+            break;
+        }
+        uint32_t run_begin = std::max((exception - 1)->begin, begin);
+        for (; i > run_begin; --i) {
+            function(i - 1, &*(exception - 1));
+        }
+    }
+}
+
+char PackedSequence::at(uint32_t i, bool is_reverse_complement) const {
+
+    uint32_t position = is_reverse_complement ? size_ - 1 - i : i;
+
+    // last run beginning at or before position
+    auto exception = std::upper_bound(exceptions_.begin(), exceptions_.end(),
+        position, [](uint32_t j, const Exception& run) -> bool {
+            return j < run.begin;
+        });
+    if (exception != exceptions_.begin() &&
+        position < (exception - 1)->begin + (exception - 1)->length) {
+        return base(*(exception - 1), position);
+    }
+
+    return kBases[is_reverse_complement ? 3 - code(position) : code(position)];
+}
+
+void PackedSequence::decode(uint32_t begin, uint32_t length,
+    bool is_reverse_complement, std::string& dst) const {
+
+    dst.reserve(dst.size() + length);
+    visit(begin, length, is_reverse_complement,
+        [&](uint32_t i, const Exception* exception) -> void {
+            if (exception != nullptr) {
+                dst += base(*exception, i);
+            } else {
+                dst += kBases[is_reverse_complement ? 3 - code(i) : code(i)];
+            }
+        });
+}
+
+std::string PackedSequence::to_string(bool is_reverse_complement) const {
+    std::string dst;
+    decode(0, size_, is_reverse_complement, dst);
+    return dst;
+}
+
+void PackedSequence::append(const PackedSequence& other, uint32_t begin,
+    uint32_t length, bool is_reverse_complement) {
+
+    words_.reserve((size_ + length + 31) / 32);
+    other.visit(begin, length, is_reverse_complement,
+        [&](uint32_t i, const Exception* exception) -> void {
+            if (exception != nullptr) {
+                push_back(other.code(i));
+                push_back_exception(exception->base, exception->is_lowercase);
+            } else {
+                push_back(is_reverse_complement ? 3 - other.code(i) :
+                    other.code(i));
+            }
+        });
+}
+
+void PackedSequence::trim(uint32_t begin, uint32_t end) {
+    PackedSequence trimmed;
+    trimmed.append(*this, begin, end - begin);
+    trimmed.shrink_to_fit();
+    std::swap(*this, trimmed);
+}
+
+void PackedSequence::shrink_to_fit() {
+    words_.shrink_to_fit();
+    exceptions_.shrink_to_fit();
+}
+
+}
@@ -0,0 +1,106 @@
+/*!
+ * @file packed_sequence.hpp
+ *
+ * @brief PackedSequence class header file
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rala {
+
+/*!
+ * @brief Nucleotide sequence stored with 2 bits per base (32 bases per word);
+ * other characters are kept in a sorted list of exception runs, either as
+ * runs of a single verbatim character (i.e. N, IUPAC codes) or as runs of
+ * lowercase (soft-masked) bases whose uppercase is packed as usual. Both
+ * kinds are left unchanged by reverse complementing. Every accessor can read
+ * the sequence either in forward or in reverse complement orientation, so
+ * that both strands can share the same storage
+ */
+class PackedSequence {
+public:
+    PackedSequence();
+    PackedSequence(const char* data, uint32_t data_length);
+    explicit PackedSequence(const std::string& data);
+
+    uint32_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    /*!
+     * @brief Returns the i-th base of the forward or reverse complement strand
+     */
+    char at(uint32_t i, bool is_reverse_complement = false) const;
+
+    /*!
+     * @brief Appends bases [begin, begin + length> of the forward or reverse
+     * complement strand to dst
+     */
+    void decode(uint32_t begin, uint32_t length, bool is_reverse_complement,
+        std::string& dst) const;
+
+    std::string to_string(bool is_reverse_complement = false) const;
+
+    /*!
+     * @brief Appends bases [begin, begin + length> of the forward or reverse
+     * complement strand of other without decoding them
+     */
+    void append(const PackedSequence& other, uint32_t begin, uint32_t length,
+        bool is_reverse_complement = false);
+
+    void trim(uint32_t begin, uint32_t end);
+
+    void shrink_to_fit();
+
+private:
+
+    struct Exception {
+        uint32_t begin;
+        uint32_t length;
+        char base; // repeated character unless is_lowercase is set
+        bool is_lowercase;
+    };
+
+    uint32_t code(uint32_t i) const {
+        return (words_[i >> 5] >> ((i & 31) << 1)) & 3;
+    }
+
+    /*!
+     * @brief Returns the base at forward position i which is covered by
+     * exception
+     */
+    char base(const Exception& exception, uint32_t i) const;
+
+    void push_back(uint32_t code);
+
+    /*!
+     * @brief Marks the last pushed base as an exception, extending the last
+     * run if possible
+     */
+    void push_back_exception(char base, bool is_lowercase);
+
+    /*!
+     * @brief Calls function(i, exception) for bases [begin, begin + length>
+     * of the forward or reverse complement strand in order, where i is the
+     * forward position of the base and exception points to the run covering
+     * it (or is nullptr)
+     */
+    template<typename T>
+    void visit(uint32_t begin, uint32_t length, bool is_reverse_complement,
+        const T& function) const;
+
+    uint32_t size_;
+    std::vector<uint64_t> words_;
+    std::vector<Exception> exceptions_;
+};
+
+}
@@ -0,0 +1,155 @@
+/*!
+ * @file paf_reader.cpp
+ *
+ * @brief PafReader class source file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <future>
+#include <iterator>
+
+#include "mapped_file.hpp"
+#include "name_table.hpp"
+#include "overlap.hpp"
+#include "paf_reader.hpp"
+
+#include "thread_pool/thread_pool.hpp"
+
+namespace rala {
+
+constexpr uint32_t kPafNumFields = 12;
+
+/*!
+ * @brief Parses the unsigned number at the beginning of [begin, end> (same as
+ * atoi() for well formed fields)
+ */
+uint32_t parseNumber(const char* begin, const char* end) {
+    uint32_t value = 0;
+    for (; begin < end && *begin >= '0' && *begin <= '9'; ++begin) {
+        value = value * 10 + (*begin - '0');
+    }
+    return value;
+}
+
+std::unique_ptr<PafReader> createPafReader(const std::string& path,
+    const NameTable& names, thread_pool::ThreadPool* thread_pool,
+    uint32_t num_threads) {
+
+    auto file = createMappedFile(path, true);
+    if (file == nullptr) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<PafReader>(new PafReader(path, std::move(file),
+        names, thread_pool, num_threads));
+}
+
+PafReader::PafReader(const std::string& path, std::unique_ptr<MappedFile> file,
+    const NameTable& names, thread_pool::ThreadPool* thread_pool,
+    uint32_t num_threads)
+        : path_(path), file_(std::move(file)), names_(&names),
+        thread_pool_(thread_pool),
+        num_threads_(std::max(num_threads, 1U)), position_(0) {
+}
+
+PafReader::~PafReader() {
+}
+
+void PafReader::reset() {
+    position_ = 0;
+}
+
+bool PafReader::parse_objects(std::vector<std::unique_ptr<Overlap>>& dst,
+    uint64_t max_bytes) {
+
+    const char* data = file_->data();
+    uint64_t size = file_->size();
+
+    // chunks end with a line break
+    uint64_t end = std::min(size, position_ + std::max<uint64_t>(max_bytes, 1));
+    if (end < size && data[end - 1] != '\n') {
+        auto line_end = static_cast<const char*>(memchr(data + end, '\n',
+            size - end));
+        end = line_end != nullptr ? line_end - data + 1 : size;
+    }
+
+    auto offsets = file_->split(position_, end, num_threads_,
+        [&](uint64_t i) -> bool {
+            return data[i - 1] == '\n';
+        });
+
+    std::vector<std::future<void>> thread_futures;
+    std::vector<std::vector<std::unique_ptr<Overlap>>> parts(
+        offsets.size() - 1);
+    for (uint32_t i = 0; i + 1 < offsets.size(); ++i) {
+        thread_futures.emplace_back(thread_pool_->submit_task(
+            [&](uint32_t part) -> void {
+                parse(offsets[part], offsets[part + 1], parts[part]);
+            }, i));
+    }
+    for (uint32_t i = 0; i < thread_futures.size(); ++i) {
+        thread_futures[i].wait();
+        dst.insert(dst.end(), std::make_move_iterator(parts[i].begin()),
+            std::make_move_iterator(parts[i].end()));
+    }
+
+    position_ = end;
+    return position_ < size;
+}
+
+void PafReader::parse(uint64_t begin, uint64_t end,
+    std::vector<std::unique_ptr<Overlap>>& dst) const {
+
+    const char* data = file_->data();
+
+    const char* fields[kPafNumFields + 1];
+    while (begin < end) {
+        const char* line = data + begin;
+        auto line_end = static_cast<const char*>(memchr(line, '\n',
+            end - begin));
+        if (line_end == nullptr) {
+            line_end = data + end;
+        }
+        begin = line_end - data + 1;
+
+        if (line == line_end) {
+            continue; // empty lines are skipped
+        }
+
+        // field i spans [fields[i], fields[i + 1] - 1>, optional fields
+        // following the mandatory ones are ignored
+        uint32_t num_fields = 0;
+        fields[num_fields++] = line;
+        for (const char* it = line; it < line_end &&
+            num_fields <= kPafNumFields; ++it) {
+            if (*it == '\t') {
+                fields[num_fields++] = it + 1;
+            }
+        }
+        if (num_fields <= kPafNumFields) {
+            if (num_fields < kPafNumFields) {
+                fprintf(stderr, "[rala::PafReader::parse] error: "
+                    "invalid line in file %s!\n", path_.c_str());
+                exit(1);
+            }
+            fields[num_fields] = line_end + 1;
+        }
+
+        auto field_length = [&](uint32_t i) -> uint32_t {
+            return fields[i + 1] - fields[i] - 1;
+        };
+        auto number = [&](uint32_t i) -> uint32_t {
+            return parseNumber(fields[i], fields[i + 1] - 1);
+        };
+
+        dst.emplace_back(new Overlap(names_->find(fields[0], field_length(0)),
+            number(1), number(2), number(3), fields[4][0],
+            names_->find(fields[5], field_length(5)), number(6), number(7),
+            number(8), number(10)));
+    }
+}
+
+}
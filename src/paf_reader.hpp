@@ -0,0 +1,78 @@
+/*!
+ * @file paf_reader.hpp
+ *
+ * @brief PafReader class header file
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace thread_pool {
+    class ThreadPool;
+}
+
+namespace rala {
+
+class Overlap;
+class MappedFile;
+class NameTable;
+
+class PafReader;
+std::unique_ptr<PafReader> createPafReader(const std::string& path,
+    const NameTable& names, thread_pool::ThreadPool* thread_pool,
+    uint32_t num_threads);
+
+/*!
+ * @brief Zero-copy parser of uncompressed PAF files (used instead of
+ * bioparser::PafParser); the file is memory-mapped and each chunk is split at
+ * line breaks into parts which are parsed in parallel, with sequence names
+ * resolved to ids through names (which has to outlive the reader) straight
+ * from the mapping; if the file can not be mapped, createPafReader() returns
+ * nullptr
+ */
+class PafReader {
+public:
+    ~PafReader();
+
+    /*!
+     * @brief Rewinds the reader to the beginning of the file
+     */
+    void reset();
+
+    /*!
+     * @brief Parses lines from about max_bytes of the file into dst, in file
+     * order; returns false if there are no more lines to parse (same as
+     * bioparser::Parser::parse_objects)
+     */
+    bool parse_objects(std::vector<std::unique_ptr<Overlap>>& dst,
+        uint64_t max_bytes);
+
+    friend std::unique_ptr<PafReader> createPafReader(const std::string& path,
+        const NameTable& names, thread_pool::ThreadPool* thread_pool,
+        uint32_t num_threads);
+private:
+    PafReader(const std::string& path, std::unique_ptr<MappedFile> file,
+        const NameTable& names, thread_pool::ThreadPool* thread_pool,
+        uint32_t num_threads);
+    PafReader(const PafReader&) = delete;
+    const PafReader& operator=(const PafReader&) = delete;
+
+    /*!
+     * @brief Parses lines of [begin, end> (begin has to start a line)
+     */
+    void parse(uint64_t begin, uint64_t end,
+        std::vector<std::unique_ptr<Overlap>>& dst) const;
+
+    std::string path_;
+    std::unique_ptr<MappedFile> file_;
+    const NameTable* names_;
+    thread_pool::ThreadPool* thread_pool_;
+    uint32_t num_threads_;
+    uint64_t position_;
+};
+
+}
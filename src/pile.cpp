@@ -6,27 +6,72 @@
 
 #include <algorithm>
 #include <sstream>
-#include <deque>
 
-#include "overlap.hpp"
 #include "pile.hpp"
 
 namespace rala {
 
-using Subpile = std::deque<std::pair<int32_t, int32_t>>;
+/*!
+ * @brief Monotonic queue of (position, value) pairs kept in a ring buffer
+ * (front holds the maximal value of the current window)
+ */
+class Subpile {
+public:
+    Subpile(uint32_t capacity)
+            : data_(), mask_(0), begin_(0), end_(0) {
+        uint32_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        data_.resize(size);
+        mask_ = size - 1;
+    }
 
-void subpileAdd(Subpile& src, int32_t value, int32_t position) {
-    while (!src.empty() && src.back().second <= value) {
-        src.pop_back();
+    bool empty() const {
+        return begin_ == end_;
     }
-    src.emplace_back(position, value);
-}
 
-void subpileUpdate(Subpile& src, int32_t position) {
-    while (!src.empty() && src.front().first <= position) {
-        src.pop_front();
+    int32_t max() const {
+        return data_[begin_ & mask_].second;
+    }
+
+    void clear() {
+        begin_ = end_ = 0;
     }
-}
+
+    void add(int32_t value, int32_t position) {
+        while (!empty() && data_[(end_ - 1) & mask_].second <= value) {
+            --end_;
+        }
+        if (end_ - begin_ == data_.size()) {
+            expand();
+        }
+        data_[end_++ & mask_] = std::make_pair(position, value);
+    }
+
+    void update(int32_t position) {
+        while (!empty() && data_[begin_ & mask_].first <= position) {
+            ++begin_;
+        }
+    }
+
+private:
+    void expand() {
+        std::vector<std::pair<int32_t, int32_t>> data(data_.size() * 2);
+        for (uint32_t i = begin_; i != end_; ++i) {
+            data[i - begin_] = data_[i & mask_];
+        }
+        end_ -= begin_;
+        begin_ = 0;
+        data_.swap(data);
+        mask_ = data_.size() - 1;
+    }
+
+    std::vector<std::pair<int32_t, int32_t>> data_;
+    uint32_t mask_;
+    uint32_t begin_;
+    uint32_t end_;
+};
 
 using Hill = std::pair<uint32_t, uint32_t>;
 
@@ -39,7 +84,9 @@ enum class HillType {
 
 HillType hillType(const std::pair<uint32_t, uint32_t>& hill_begin,
     const std::pair<uint32_t, uint32_t>& hill_end, uint32_t dataset_median,
-    const std::vector<uint16_t>& pile, uint32_t begin, uint32_t end) {
+    const Coverage& coverage, uint32_t begin, uint32_t end) {
+
+    Coverage::Reader pile(coverage);
 
     if (hill_end.second - (hill_begin.first >> 1) > 0.84 * (end - begin)) {
         return HillType::kInvalid;
@@ -97,192 +144,131 @@ void hillMerge(std::vector<std::pair<uint32_t, uint32_t>>& hills) {
     hills.swap(tmp);
 }
 
-std::unique_ptr<Pile> createPile(uint64_t id, uint32_t read_length) {
-    return std::unique_ptr<Pile>(new Pile(id, read_length));
-}
-
-Pile::Pile(uint64_t id, uint32_t read_length)
-        : id_(id), begin_(0), end_(read_length), p10_(0), median_(0),
-        data_(end_ - begin_, 0), corrected_data_(), hills_() {
-}
-
-std::vector<std::pair<uint32_t, uint32_t>> Pile::find_slopes(double q) {
-
-    std::vector<std::pair<uint32_t, uint32_t>> slope_regions;
-
-    int32_t k = 847;
-    int32_t read_length = data_.size();
+void slopesRearrange(std::vector<std::pair<uint32_t, uint32_t>>& slope_regions,
+    const Coverage& coverage, double q) {
 
-    Subpile left_subpile;
-    uint32_t first_down = 0, last_down = 0;
-    bool found_down = false;
+    Coverage::Reader data(coverage);
 
-    Subpile right_subpile;
-    uint32_t first_up = 0, last_up = 0;
-    bool found_up = false;
+    std::sort(slope_regions.begin(), slope_regions.end());
 
-    // find slope regions
-    for (int32_t i = 0; i < k; ++i) {
-        subpileAdd(right_subpile, data_[i], i);
-    }
-    for (int32_t i = 0; i < read_length; ++i) {
-        if (i > 0) {
-            subpileAdd(left_subpile, data_[i - 1], i - 1);
-        }
-        subpileUpdate(left_subpile, i - 1 - k);
+    Subpile subpile(1024);
+    std::vector<std::pair<uint32_t, uint32_t>> subregions;
 
-        if (i < read_length - k) {
-            subpileAdd(right_subpile, data_[i + k], i + k);
+    // each fix-up only moves region i to the right and adds subregions which
+    // lie after it, so the sorted prefix stays intact and the sweep resumes
+    // from the previous region
+    for (uint32_t i = 0; i + 1 < slope_regions.size();) {
+        if (slope_regions[i].second <= (slope_regions[i + 1].first >> 1)) {
+            ++i;
+            continue;
         }
-        subpileUpdate(right_subpile, i);
 
-        int32_t current_value = data_[i] * q;
-        if (i != 0 && left_subpile.front().second > current_value) {
-            if (found_down) {
-                if (i - last_down > 1) {
-                    slope_regions.emplace_back(first_down << 1 | 0, last_down);
-                    first_down = i;
-                }
-            } else {
-                found_down = true;
-                first_down = i;
-            }
-            last_down = i;
-        }
-        if (i != (read_length - 1) && right_subpile.front().second > current_value) {
-            if (found_up) {
-                if (i - last_up > 1) {
-                    slope_regions.emplace_back(first_up << 1 | 1, last_up);
-                    first_up = i;
-                }
-            } else {
-                found_up = true;
-                first_up = i;
-            }
-            last_up = i;
-        }
-    }
-    if (found_down) {
-        slope_regions.emplace_back(first_down << 1 | 0, last_down);
-    }
-    if (found_up) {
-        slope_regions.emplace_back(first_up << 1 | 1, last_up);
-    }
+        subpile.clear();
+        subregions.clear();
+        uint32_t first = 0, last = 0;
+        bool found = false;
 
-    // rearrange overlapping regions
-    while (true) {
-        std::sort(slope_regions.begin(), slope_regions.end());
+        if (slope_regions[i].first & 1) {
+            uint32_t subpile_begin = slope_regions[i].first >> 1;
+            uint32_t subpile_end = std::min(slope_regions[i].second,
+                slope_regions[i + 1].second);
 
-        bool is_changed = false;
-        for (uint32_t i = 0; i < slope_regions.size() - 1; ++i) {
-            if (slope_regions[i].second <= (slope_regions[i + 1].first >> 1)) {
-                continue;
+            for (uint32_t j = subpile_begin; j < subpile_end + 1; ++j) {
+                subpile.add(data[j], j);
             }
-
-            std::vector<std::pair<uint32_t, uint32_t>> subregions;
-            if (slope_regions[i].first & 1) {
-                right_subpile.clear();
-                found_up = false;
-
-                uint32_t subpile_begin = slope_regions[i].first >> 1;
-                uint32_t subpile_end = std::min(slope_regions[i].second,
-                    slope_regions[i + 1].second);
-
-                for (uint32_t j = subpile_begin; j < subpile_end + 1; ++j) {
-                    subpileAdd(right_subpile, data_[j], j);
-                }
-                for (uint32_t j = subpile_begin; j < subpile_end; ++j) {
-                    subpileUpdate(right_subpile, j);
-                    if (data_[j] * q < right_subpile.front().second) {
-                        if (found_up) {
-                            if (j - last_up > 1) {
-                                subregions.emplace_back(first_up, last_up);
-                                first_up = j;
-                            }
-                        } else {
-                            found_up = true;
-                            first_up = j;
+            for (uint32_t j = subpile_begin; j < subpile_end; ++j) {
+                subpile.update(j);
+                if (data[j] * q < subpile.max()) {
+                    if (found) {
+                        if (j - last > 1) {
+                            subregions.emplace_back(first << 1 | 1, last);
+                            first = j;
                         }
-                        last_up = j;
+                    } else {
+                        found = true;
+                        first = j;
                     }
+                    last = j;
                 }
-                if (found_up) {
-                    subregions.emplace_back(first_up, last_up);
-                }
+            }
+            if (found) {
+                subregions.emplace_back(first << 1 | 1, last);
+            }
 
-                for (const auto& it: subregions) {
-                    slope_regions.emplace_back(it.first << 1 | 1, it.second);
-                }
-                slope_regions[i].first = subpile_end << 1 | 1;
+            slope_regions[i].first = subpile_end << 1 | 1;
 
-            } else {
-                left_subpile.clear();
-                found_down = false;
-
-                uint32_t subpile_begin = std::max(slope_regions[i].first >> 1,
-                    slope_regions[i + 1].first >> 1);
-                uint32_t subpile_end = slope_regions[i].second;
-
-                for (uint32_t j = subpile_begin; j < subpile_end + 1; ++j) {
-                    if (!left_subpile.empty() && data_[j] * q < left_subpile.front().second) {
-                        if (found_down) {
-                            if (j - last_down > 1) {
-                                subregions.emplace_back(first_down, last_down);
-                                first_down = j;
-                            }
-                        } else {
-                            found_down = true;
-                            first_down = j;
+        } else {
+            uint32_t subpile_begin = std::max(slope_regions[i].first >> 1,
+                slope_regions[i + 1].first >> 1);
+            uint32_t subpile_end = slope_regions[i].second;
+
+            for (uint32_t j = subpile_begin; j < subpile_end + 1; ++j) {
+                if (!subpile.empty() && data[j] * q < subpile.max()) {
+                    if (found) {
+                        if (j - last > 1) {
+                            subregions.emplace_back(first << 1 | 0, last);
+                            first = j;
                         }
-                        last_down = j;
+                    } else {
+                        found = true;
+                        first = j;
                     }
-                    subpileAdd(left_subpile, data_[j], j);
-                }
-                if (found_down) {
-                    subregions.emplace_back(first_down, last_down);
-                }
-
-                for (const auto& it: subregions) {
-                    slope_regions.emplace_back(it.first << 1 | 0, it.second);
+                    last = j;
                 }
-                slope_regions[i].second = subpile_begin;
+                subpile.add(data[j], j);
+            }
+            if (found) {
+                subregions.emplace_back(first << 1 | 0, last);
             }
 
-            is_changed = true;
-            break;
+            slope_regions[i].second = subpile_begin;
         }
 
-        if (!is_changed) {
-            break;
+        auto begin = slope_regions.begin() + i;
+        auto end = slope_regions.end();
+        std::rotate(begin, begin + 1, std::upper_bound(begin + 1, end, *begin));
+
+        slope_regions.insert(slope_regions.end(), subregions.begin(),
+            subregions.end());
+        std::inplace_merge(slope_regions.begin() + i, slope_regions.end() -
+            subregions.size(), slope_regions.end());
+
+        if (i > 0) {
+            --i;
         }
     }
+}
+
+void slopesNarrow(std::vector<std::pair<uint32_t, uint32_t>>& slope_regions,
+    const Coverage& coverage, double q, uint32_t k) {
+
+    Coverage::Reader data(coverage);
 
-    // narrow slope regions
-    for (uint32_t i = 0; i < slope_regions.size() - 1; ++i) {
+    for (uint32_t i = 0; i + 1 < slope_regions.size(); ++i) {
         if ((slope_regions[i].first & 1) && !(slope_regions[i + 1].first & 1)) {
 
             uint32_t subpile_begin = slope_regions[i].second;
             uint32_t subpile_end = slope_regions[i + 1].first >> 1;
 
-            if (subpile_end - subpile_begin > static_cast<uint32_t>(k)) {
+            if (subpile_end - subpile_begin > k) {
                 continue;
             }
 
             uint16_t max_subpile_coverage = 0;
             for (uint32_t j = subpile_begin + 1; j < subpile_end; ++j) {
-                max_subpile_coverage = std::max(max_subpile_coverage, data_[j]);
+                max_subpile_coverage = std::max(max_subpile_coverage, data[j]);
             }
 
             uint32_t last_valid_point = slope_regions[i].first >> 1;
             for (uint32_t j = slope_regions[i].first >> 1; j <= subpile_begin; ++j) {
-                if (max_subpile_coverage > data_[j] * q) {
+                if (max_subpile_coverage > data[j] * q) {
                     last_valid_point = j;
                 }
             }
 
             uint32_t first_valid_point = slope_regions[i + 1].second;
             for (uint32_t j = subpile_end; j <= slope_regions[i + 1].second; ++j) {
-                if (max_subpile_coverage > data_[j] * q) {
+                if (max_subpile_coverage > data[j] * q) {
                     first_valid_point = j;
                     break;
                 }
@@ -292,6 +278,129 @@ std::vector<std::pair<uint32_t, uint32_t>> Pile::find_slopes(double q) {
             slope_regions[i + 1].first = first_valid_point << 1 | 0;
         }
     }
+}
+
+void segmentsMax(Coverage::Segments& segments,
+    const Coverage::Segments& other_segments) {
+
+    thread_local Coverage::Segments dst;
+    dst.clear();
+
+    uint16_t value = 0, other_value = 0;
+    for (uint32_t i = 0, j = 0;
+        i < segments.size() || j < other_segments.size();) {
+
+        uint32_t position = std::min(
+            i < segments.size() ? segments[i].first : UINT32_MAX,
+            j < other_segments.size() ? other_segments[j].first : UINT32_MAX);
+        for (; i < segments.size() && segments[i].first == position; ++i) {
+            value = segments[i].second;
+        }
+        for (; j < other_segments.size() && other_segments[j].first == position; ++j) {
+            other_value = other_segments[j].second;
+        }
+        uint16_t max_value = std::max(value, other_value);
+        if (dst.empty() || dst.back().second != max_value) {
+            dst.emplace_back(position, max_value);
+        }
+    }
+
+    segments.swap(dst);
+}
+
+std::unique_ptr<Pile> createPile(uint64_t id, uint32_t read_length,
+    bool is_compressed) {
+    return std::unique_ptr<Pile>(new Pile(id, read_length, is_compressed));
+}
+
+Pile::Pile(uint64_t id, uint32_t read_length, bool is_compressed)
+        : id_(id), begin_(0), end_(read_length), p10_(0), median_(0),
+        data_(end_ - begin_, is_compressed), corrected_data_(), hills_() {
+}
+
+std::vector<std::vector<std::pair<uint32_t, uint32_t>>> Pile::find_slopes(
+    const std::vector<double>& q) const {
+
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> slope_regions(q.size());
+
+    int32_t k = 847;
+    int32_t read_length = data_.size();
+
+    struct Slope {
+        uint32_t first;
+        uint32_t last;
+        bool is_found;
+    };
+
+    Coverage::Reader left(data_), current(data_), right(data_);
+
+    Subpile left_subpile(k + 1);
+    std::vector<Slope> downs(q.size(), Slope{0, 0, false});
+
+    Subpile right_subpile(k + 1);
+    std::vector<Slope> ups(q.size(), Slope{0, 0, false});
+
+    // find slope regions for all q in one sweep (window maxima are shared)
+    for (int32_t i = 0; i < std::min(k, read_length); ++i) {
+        right_subpile.add(right[i], i);
+    }
+    for (int32_t i = 0; i < read_length; ++i) {
+        if (i > 0) {
+            left_subpile.add(left[i - 1], i - 1);
+        }
+        left_subpile.update(i - 1 - k);
+
+        if (i < read_length - k) {
+            right_subpile.add(right[i + k], i + k);
+        }
+        right_subpile.update(i);
+
+        uint16_t value = current[i];
+        for (uint32_t j = 0; j < q.size(); ++j) {
+            int32_t current_value = value * q[j];
+            if (i != 0 && left_subpile.max() > current_value) {
+                auto& down = downs[j];
+                if (down.is_found) {
+                    if (i - down.last > 1) {
+                        slope_regions[j].emplace_back(down.first << 1 | 0, down.last);
+                        down.first = i;
+                    }
+                } else {
+                    down.is_found = true;
+                    down.first = i;
+                }
+                down.last = i;
+            }
+            if (i != (read_length - 1) && right_subpile.max() > current_value) {
+                auto& up = ups[j];
+                if (up.is_found) {
+                    if (i - up.last > 1) {
+                        slope_regions[j].emplace_back(up.first << 1 | 1, up.last);
+                        up.first = i;
+                    }
+                } else {
+                    up.is_found = true;
+                    up.first = i;
+                }
+                up.last = i;
+            }
+        }
+    }
+
+    for (uint32_t j = 0; j < q.size(); ++j) {
+        if (downs[j].is_found) {
+            slope_regions[j].emplace_back(downs[j].first << 1 | 0, downs[j].last);
+        }
+        if (ups[j].is_found) {
+            slope_regions[j].emplace_back(ups[j].first << 1 | 1, ups[j].last);
+        }
+
+        // rearrange overlapping regions
+        slopesRearrange(slope_regions[j], data_, q[j]);
+
+        // narrow slope regions
+        slopesNarrow(slope_regions[j], data_, q[j], k);
+    }
 
     return slope_regions;
 }
@@ -302,15 +411,26 @@ void Pile::find_median() {
         corrected_data_.swap(data_);
     }
 
-    std::vector<uint16_t> valid_data(data_.begin() + begin_, data_.begin() + end_);
+    // histogram of coverage values, kept zeroed between calls
+    thread_local std::vector<uint64_t> histogram;
+    thread_local Coverage::Segments segments;
+    data_.segments(begin_, end_, segments);
 
-    std::nth_element(valid_data.begin(), valid_data.begin() + valid_data.size() / 2,
-        valid_data.end());
-    median_ = valid_data[valid_data.size() / 2];
+    uint16_t max_value = 0;
+    for (uint32_t i = 0; i < segments.size(); ++i) {
+        uint32_t segment_end = i + 1 < segments.size() ? segments[i + 1].first : end_;
+        if (histogram.size() <= segments[i].second) {
+            histogram.resize(segments[i].second + 1, 0);
+        }
+        histogram[segments[i].second] += segment_end - segments[i].first;
+        max_value = std::max(max_value, segments[i].second);
+    }
 
-    std::nth_element(valid_data.begin(), valid_data.begin() + valid_data.size() / 10,
-        valid_data.end());
-    p10_ = valid_data[valid_data.size() / 10];
+    median_ = histogramSelect(histogram, (end_ - begin_) / 2);
+    p10_ = histogramSelect(histogram, (end_ - begin_) / 10);
+
+    std::fill(histogram.begin(), histogram.begin() + std::min<uint64_t>(
+        histogram.size(), max_value + 1), 0);
 
     if (!corrected_data_.empty()) {
         corrected_data_.swap(data_);
@@ -323,23 +443,67 @@ void Pile::add_layers(std::vector<uint32_t>& overlap_bounds) {
         return;
     }
 
-    std::sort(overlap_bounds.begin(), overlap_bounds.end());
+    if (data_.is_compressed()) {
+        std::sort(overlap_bounds.begin(), overlap_bounds.end());
 
-    uint16_t coverage = 0;
-    uint32_t last_bound = 0;
-    for (const auto& bound: overlap_bounds) {
-        if (coverage > 0) {
-            for (uint32_t i = last_bound; i < (bound >> 1); ++i) {
-                data_[i] += coverage;
+        uint32_t begin = overlap_bounds.front() >> 1,
+            end = overlap_bounds.back() >> 1;
+
+        thread_local Coverage::Segments segments, layers;
+        data_.segments(begin, end, segments);
+        layers.clear();
+
+        // sweep over bounds and segments of current coverage at once
+        int32_t coverage = 0;
+        uint16_t value = 0;
+        for (uint32_t i = 0, j = 0;;) {
+            uint32_t position = std::min(
+                i < overlap_bounds.size() ? overlap_bounds[i] >> 1 : end,
+                j < segments.size() ? segments[j].first : end);
+            if (position >= end) {
+                break;
+            }
+            for (; i < overlap_bounds.size() && (overlap_bounds[i] >> 1) == position; ++i) {
+                coverage += overlap_bounds[i] & 1 ? -1 : 1;
+            }
+            for (; j < segments.size() && segments[j].first == position; ++j) {
+                value = segments[j].second;
+            }
+            uint16_t layer = value + coverage;
+            if (layers.empty() || layers.back().second != layer) {
+                layers.emplace_back(position, layer);
             }
         }
-        last_bound = bound >> 1;
+
+        data_.assign(begin, end, layers);
+        return;
+    }
+
+    // difference array of coverage events, kept zeroed between calls
+    thread_local std::vector<int32_t> events;
+    if (events.size() < data_.size() + 1) {
+        events.resize(data_.size() + 1, 0);
+    }
+
+    uint32_t begin = data_.size(), end = 0;
+    for (const auto& bound: overlap_bounds) {
+        uint32_t position = bound >> 1;
         if (bound & 1) {
-            --coverage;
+            --events[position];
         } else {
-            ++coverage;
+            ++events[position];
         }
+        begin = std::min(begin, position);
+        end = std::max(end, position);
+    }
+
+    int32_t coverage = 0;
+    for (uint32_t i = begin; i < end; ++i) {
+        coverage += events[i];
+        events[i] = 0;
+        data_.set(i, data_[i] + coverage);
     }
+    events[end] = 0;
 }
 
 bool Pile::shrink(uint32_t begin, uint32_t end) {
@@ -354,23 +518,20 @@ bool Pile::shrink(uint32_t begin, uint32_t end) {
         return false;
     }
 
-    for (uint32_t i = begin_; i < begin; ++i) {
-        data_[i] = 0;
-    }
+    data_.fill(begin_, begin, 0);
     begin_ = begin;
 
-    for (uint32_t i = end; i < end_; ++i) {
-        data_[i] = 0;
-    }
+    data_.fill(end, end_, 0);
     end_ = end;
 
     return true;
 }
 
-void Pile::correct(const std::vector<std::shared_ptr<Overlap>>& overlaps,
+void Pile::correct(const std::vector<PileOverlap>& overlaps,
+    uint64_t overlaps_begin, uint64_t overlaps_end,
     const std::vector<std::unique_ptr<Pile>>& piles) {
 
-    if (overlaps.empty()) {
+    if (overlaps_begin == overlaps_end) {
         return;
     }
 
@@ -378,28 +539,20 @@ void Pile::correct(const std::vector<std::shared_ptr<Overlap>>& overlaps,
         corrected_data_ = data_;
     }
 
-    for (const auto& it: overlaps) {
+    for (uint64_t j = overlaps_begin; j < overlaps_end; ++j) {
+        const auto& it = overlaps[j];
 
-        const auto& other = piles[(it->a_id() == id_ ? it->b_id() : it->a_id())];
+        const auto& other = piles[it.other_id];
 
         if (other == nullptr) {
             fprintf(stderr, "[rala::Pile::correct] error: missing other pile!\n");
             exit(1);
         }
 
-        uint32_t begin, end, other_begin, other_end;
-
-        if (it->a_id() == id_) {
-            begin = begin_ + it->a_begin();
-            end = begin_ + it->a_end();
-            other_begin = other->begin_ + it->b_begin();
-            other_end = other->begin_ + it->b_end();
-        } else {
-            begin = begin_ + it->b_begin();
-            end = begin_ + it->b_end();
-            other_begin = other->begin_ + it->a_begin();
-            other_end = other->begin_ + it->a_end();
-        }
+        uint32_t begin = begin_ + it.begin;
+        uint32_t end = begin_ + it.end;
+        uint32_t other_begin = other->begin_ + it.other_begin;
+        uint32_t other_end = other->begin_ + it.other_end;
 
         if (begin < begin_ || begin >= end_ || end <= begin_ || end > end_) {
             fprintf(stderr, "[rala::Pile::correct] error: "
@@ -416,27 +569,50 @@ void Pile::correct(const std::vector<std::shared_ptr<Overlap>>& overlaps,
         uint32_t correction_length = std::min(other_end - other_begin,
             end - begin);
 
-        for (uint32_t i = 0; i < correction_length; ++i) {
-            if (it->orientation() == 0) {
-                corrected_data_[begin + i] = std::max(corrected_data_[begin + i],
-                    other->data_[other_begin + i]);
+        if (corrected_data_.is_compressed()) {
+            thread_local Coverage::Segments segments, other_segments;
+
+            if (it.orientation == 0) {
+                other->data_.segments(other_begin, other_begin +
+                    correction_length, other_segments);
+                for (auto& jt: other_segments) {
+                    jt.first = jt.first - other_begin + begin;
+                }
             } else {
-                corrected_data_[begin + i] = std::max(corrected_data_[begin + i],
-                    other->data_[other_end - i - 1]);
+                other->data_.segments(other_end - correction_length, other_end,
+                    segments);
+                other_segments.clear();
+                for (uint32_t i = segments.size(); i > 0; --i) {
+                    uint32_t segment_end = i < segments.size() ?
+                        segments[i].first : other_end;
+                    other_segments.emplace_back(begin + other_end - segment_end,
+                        segments[i - 1].second);
+                }
             }
+
+            corrected_data_.segments(begin, begin + correction_length, segments);
+            segmentsMax(segments, other_segments);
+            corrected_data_.assign(begin, begin + correction_length, segments);
+            continue;
         }
+
+        corrected_data_.merge_max(begin, other->data_, it.orientation == 0 ?
+            other_begin : other_end - correction_length, correction_length,
+            it.orientation != 0);
     }
 }
 
 bool Pile::find_valid_region() {
 
+    Coverage::Reader data(data_);
+
     uint32_t new_begin = 0, new_end = 0, current_begin = 0;
     bool found_begin = false;
     for (uint32_t i = begin_; i < end_; ++i) {
-        if (!found_begin && data_[i] >= 3) {
+        if (!found_begin && data[i] >= 3) {
             current_begin = i;
             found_begin = true;
-        } else if (found_begin && data_[i] < 3) {
+        } else if (found_begin && data[i] < 3) {
             if (i - current_begin > new_end - new_begin) {
                 new_begin = current_begin;
                 new_end = i;
@@ -460,13 +636,17 @@ bool Pile::find_chimeric_regions(uint16_t dataset_median) {
         dataset_median = std::max(dataset_median, p10_);
     }
 
+    // slopes for chimeric pits and hills are found in one sweep
+    auto all_slope_regions = find_slopes({1.817, 1.3});
+
     // look for chimeric pits
-    auto slope_regions = find_slopes(1.817);
+    auto& slope_regions = all_slope_regions[0];
 
     if (!slope_regions.empty()) {
+        Coverage::Reader data(data_);
         auto is_chimeric_slope_region = [&](uint32_t begin, uint32_t end) -> bool {
             for (uint32_t i = begin; i < end; ++i) {
-                if (data_[i] <= dataset_median / 2) {
+                if (data[i] <= dataset_median / 2) {
                     return true;
                 }
             }
@@ -474,7 +654,7 @@ bool Pile::find_chimeric_regions(uint16_t dataset_median) {
         };
 
         uint32_t new_begin = 0, new_end = 0, last_slope = begin_;
-        for (uint32_t i = 0; i < slope_regions.size() - 1; ++i) {
+        for (uint32_t i = 0; i + 1 < slope_regions.size(); ++i) {
             if (!(slope_regions[i].first & 1) && (slope_regions[i + 1].first & 1)) {
                 bool is_chimeric =
                     (is_chimeric_slope_region(
@@ -499,16 +679,20 @@ bool Pile::find_chimeric_regions(uint16_t dataset_median) {
             new_begin = last_slope;
             new_end = end_;
         }
+        uint32_t begin = begin_, end = end_;
         if (!shrink(new_begin, new_end)) {
             return false;
         }
+        if (begin_ != begin || end_ != end) {
+            all_slope_regions[1] = find_slopes({1.3})[0];
+        }
     }
 
     // look for chimeric hills
-    slope_regions = find_slopes(1.3);
+    slope_regions.swap(all_slope_regions[1]);
 
     std::vector<std::pair<uint32_t, uint32_t>> chimeric_hills;
-    for (uint32_t i = 0; i < slope_regions.size() - 1; ++i) {
+    for (uint32_t i = 0; i + 1 < slope_regions.size(); ++i) {
         if (!(slope_regions[i].first & 1)) {
             continue;
         }
@@ -569,10 +753,10 @@ void Pile::find_repetitive_regions(uint16_t dataset_median) {
         dataset_median = std::max(dataset_median, p10_);
     }
 
-    auto slope_regions = find_slopes(1.3);
+    auto slope_regions = find_slopes({1.3})[0];
 
     std::vector<std::pair<uint32_t, uint32_t>> repeat_hills;
-    for (uint32_t i = 0; i < slope_regions.size() - 1; ++i) {
+    for (uint32_t i = 0; i + 1 < slope_regions.size(); ++i) {
         if (!(slope_regions[i].first & 1)) {
             continue;
         }
@@ -644,9 +828,11 @@ std::string Pile::to_json() const {
     std::stringstream ss;
     ss << "\"" << id_ << "\":{";
 
+    Coverage::Reader data(data_), corrected_data(corrected_data_);
+
     ss << "\"y\":[";
     for (uint32_t i = 0; i < data_.size(); ++i) {
-        ss << data_[i];
+        ss << data[i];
         if (i < data_.size() - 1) {
             ss << ",";
         }
@@ -655,7 +841,7 @@ std::string Pile::to_json() const {
 
     ss << "\"~y\":[";
     for (uint32_t i = 0; i < corrected_data_.size(); ++i) {
-        ss << corrected_data_[i];
+        ss << corrected_data[i];
         if (i < corrected_data_.size() - 1) {
             ss << ",";
         }
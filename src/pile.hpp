@@ -11,12 +11,27 @@
 #include <string>
 #include <vector>
 
+#include "coverage.hpp"
+
 namespace rala {
 
-class Overlap;
+/*!
+ * @brief Transmuted overlap as seen from one of its piles, [begin, end> lies
+ * on the pile and [other_begin, other_end> on the pile with id other_id
+ * (coordinates are relative to begin of the respective pile)
+ */
+struct PileOverlap {
+    uint32_t other_id;
+    uint32_t begin;
+    uint32_t end;
+    uint32_t other_begin;
+    uint32_t other_end;
+    uint32_t orientation;
+};
 
 class Pile;
-std::unique_ptr<Pile> createPile(uint64_t id, uint32_t sequence_length);
+std::unique_ptr<Pile> createPile(uint64_t id, uint32_t sequence_length,
+    bool is_compressed);
 
 class Pile {
 public:
@@ -46,7 +61,7 @@ public:
 
     void find_median();
 
-    const std::vector<uint16_t>& data() const {
+    const Coverage& data() const {
         if (corrected_data_.empty()) {
             return data_;
         }
@@ -54,7 +69,8 @@ public:
     }
 
     /*!
-     * @brief Adds overlaps to data_
+     * @brief Adds overlaps to data_ (encoded bounds are accumulated as +1/-1
+     * events and applied with a single prefix sum)
      */
     void add_layers(std::vector<uint32_t>& overlap_bounds);
 
@@ -66,9 +82,10 @@ public:
 
     /*!
      * @brief Corrects data_ with other piles which have overlapping regions
+     * (overlaps [overlaps_begin, overlaps_end> all belong to this pile)
      */
-    void correct(const std::vector<std::shared_ptr<Overlap>>& overlaps,
-        const std::vector<std::unique_ptr<Pile>>& piles);
+    void correct(const std::vector<PileOverlap>& overlaps,
+        uint64_t overlaps_begin, uint64_t overlaps_end, const std::vector<std::unique_ptr<Pile>>& piles);
 
     /*!
      * @brief Locates region in data_ with values greater or equal to predefined
@@ -103,21 +120,27 @@ public:
      */
     std::string to_json() const;
 
-    friend std::unique_ptr<Pile> createPile(uint64_t id, uint32_t sequence_length);
+    friend std::unique_ptr<Pile> createPile(uint64_t id, uint32_t sequence_length,
+        bool is_compressed);
 private:
-    Pile(uint64_t id, uint32_t sequence_length);
+    Pile(uint64_t id, uint32_t sequence_length, bool is_compressed);
     Pile(const Pile&) = delete;
     const Pile& operator=(const Pile&) = delete;
 
-    std::vector<std::pair<uint32_t, uint32_t>> find_slopes(double q);
+    /*!
+     * @brief Finds slope regions for each ratio in q with a single sweep over
+     * data_ (sliding window maxima are kept in monotonic queues)
+     */
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> find_slopes(
+        const std::vector<double>& q) const;
 
     uint64_t id_;
     uint32_t begin_;
     uint32_t end_;
     uint16_t p10_;
     uint16_t median_;
-    std::vector<uint16_t> data_;
-    std::vector<uint16_t> corrected_data_;
+    Coverage data_;
+    Coverage corrected_data_;
     std::vector<std::pair<uint32_t, uint32_t>> hills_;
 };
 
@@ -11,6 +11,8 @@
 #include <string>
 #include <vector>
 
+#include "packed_sequence.hpp"
+
 namespace bioparser {
     template<class T>
     class FastaParser;
@@ -24,6 +26,8 @@ namespace rala {
 class Sequence;
 std::unique_ptr<Sequence> createSequence(const std::string& name,
     const std::string& data);
+std::unique_ptr<Sequence> createSequence(const std::string& name,
+    const PackedSequence& data);
 
 class Sequence {
 public:
@@ -33,21 +37,20 @@ public:
         return name_;
     }
 
-    const std::string& data() const {
+    /*!
+     * @brief Returns 2-bit packed bases, the reverse complement is obtained
+     * by decoding them in reverse complement orientation
+     */
+    const PackedSequence& data() const {
         return data_;
     }
 
-    const std::string& reverse_complement() {
-        if (reverse_complement_.size() != data_.size()) {
-            create_reverse_complement();
-        }
-        return reverse_complement_;
-    }
-
     void trim(uint32_t begin, uint32_t end);
 
     friend std::unique_ptr<Sequence> createSequence(const std::string& name,
         const std::string& data);
+    friend std::unique_ptr<Sequence> createSequence(const std::string& name,
+        const PackedSequence& data);
 
     friend bioparser::FastaParser<Sequence>;
     friend bioparser::FastqParser<Sequence>;
@@ -56,14 +59,12 @@ private:
         uint32_t data_length);
     Sequence(const char* name, uint32_t name_length, const char* data,
         uint32_t sequence_length, const char* quality, uint32_t quality_length);
+    Sequence(const std::string& name, const PackedSequence& data);
     Sequence(const Sequence&) = delete;
     const Sequence& operator=(const Sequence&) = delete;
 
-    void create_reverse_complement();
-
     std::string name_;
-    std::string data_;
-    std::string reverse_complement_;
+    PackedSequence data_;
 };
 
 }
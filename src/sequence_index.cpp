@@ -0,0 +1,392 @@
+/*!
+ * @file sequence_index.cpp
+ *
+ * @brief SequenceIndex class source file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <fstream>
+#include <future>
+
+#include "input_file.hpp"
+#include "mapped_file.hpp"
+#include "packed_sequence.hpp"
+#include "sequence.hpp"
+#include "sequence_index.hpp"
+
+#include "thread_pool/thread_pool.hpp"
+
+namespace rala {
+
+constexpr uint32_t kScanBufferSize = 1024 * 1024;
+
+struct Record {
+    std::string name;
+    uint64_t length;
+    uint64_t begin; // range of sequence lines
+    uint64_t end;
+};
+
+bool isFastq(char first, const std::string& path) {
+    if (first != '>' && first != '@') {
+        fprintf(stderr, "[rala::SequenceIndex::scan] error: "
+            "file %s is not in FASTA/FASTQ format!\n", path.c_str());
+        exit(1);
+    }
+    return first == '@';
+}
+
+/*!
+ * @brief Collects names, lengths and sequence ranges of records from
+ * consecutive blocks of a FASTA/FASTQ file (a FASTA record is a name line and
+ * any number of sequence lines, a FASTQ record spans four lines); the first
+ * block has to begin at a record
+ */
+class RecordScanner {
+public:
+    RecordScanner(bool is_fastq, std::vector<Record>& dst)
+            : dst_(dst), is_fastq_(is_fastq), is_record_(false),
+            is_line_begin_(true), fastq_line_(0), line_(Line::kSkipped),
+            record_() {
+    }
+
+    void feed(const char* data, uint64_t size, uint64_t position) {
+
+        for (uint64_t i = 0; i < size; ++i) {
+            char c = data[i];
+
+            if (is_line_begin_) {
+                if (c == '\n') {
+                    continue; // empty lines are skipped
+                }
+                // FASTA sequence lines end where the next record begins,
+                // FASTQ ones at the separator line
+                if (!is_fastq_ || fastq_line_ == 2) {
+                    record_.end = position + i;
+                }
+                is_line_begin_ = false;
+
+                if (is_fastq_) {
+                    if (fastq_line_ == 0) {
+                        begin_record();
+                        fastq_line_ = 1;
+                        continue;
+                    }
+                    line_ = fastq_line_ == 1 ? Line::kSequence : Line::kSkipped;
+                    fastq_line_ = (fastq_line_ + 1) % 4;
+                } else if (c == '>') {
+                    begin_record();
+                    continue;
+                } else {
+                    line_ = Line::kSequence;
+                }
+            }
+
+            if (c == '\n') {
+                if (line_ == Line::kName) {
+                    record_.begin = position + i + 1;
+                }
+                is_line_begin_ = true;
+                continue;
+            }
+            if (line_ == Line::kName) {
+                record_.name.push_back(c);
+            } else if (line_ == Line::kSequence && c != '\r') {
+                ++record_.length;
+            }
+        }
+    }
+
+    /*!
+     * @brief Stores the last record which ends at position
+     */
+    void finish(uint64_t position) {
+        if (!is_fastq_ || fastq_line_ == 2) {
+            record_.end = position;
+        }
+        store_record();
+    }
+
+private:
+    enum class Line {
+        kName,
+        kSequence,
+        kSkipped
+    };
+
+    void begin_record() {
+        store_record();
+        is_record_ = true;
+        line_ = Line::kName;
+    }
+
+    void store_record() {
+        if (!is_record_) {
+            return;
+        }
+        // names end at the first whitespace, as in samtools indices and
+        // overlap files
+        auto& name = record_.name;
+        name.resize(std::min(name.size(), name.find_first_of(" \t\r")));
+        if (record_.length > UINT32_MAX) {
+            fprintf(stderr, "[rala::SequenceIndex::scan] error: "
+                "sequence %s is too long!\n", name.c_str());
+            exit(1);
+        }
+        record_.end = std::max(record_.begin, record_.end);
+        dst_.emplace_back(std::move(record_));
+
+        record_ = Record();
+        is_record_ = false;
+    }
+
+    std::vector<Record>& dst_;
+    bool is_fastq_;
+    bool is_record_;
+    bool is_line_begin_;
+    uint32_t fastq_line_; // of the current record
+    Line line_;
+    Record record_;
+};
+
+std::unique_ptr<SequenceIndex> createSequenceIndex(const std::string& path,
+    InputFile* file, thread_pool::ThreadPool* thread_pool,
+    uint32_t num_threads) {
+
+    std::unique_ptr<SequenceIndex> index(new SequenceIndex());
+
+    if (!index->load_fai(path, path + ".fai")) {
+        file->rewind();
+        index->scan(file->path(), file->is_plain(), thread_pool, num_threads);
+    }
+    // offsets into decompressed data can not be read directly
+    if (!file->is_plain()) {
+        std::vector<std::pair<uint64_t, uint64_t>>().swap(index->ranges_);
+    }
+    index->names_.shrink_to_fit();
+    index->lengths_.shrink_to_fit();
+    index->ranges_.shrink_to_fit();
+
+    return index;
+}
+
+SequenceIndex::SequenceIndex()
+        : names_(), lengths_(), ranges_(), is_from_fai_(false) {
+}
+
+void SequenceIndex::add(const std::string& name, uint32_t length,
+    uint64_t begin, uint64_t end) {
+    names_.add(name.c_str(), name.size());
+    lengths_.emplace_back(length);
+    ranges_.emplace_back(begin, end);
+}
+
+std::unique_ptr<Sequence> SequenceIndex::load(const MappedFile& file,
+    uint64_t i) const {
+
+    const char* data = file.data() + ranges_[i].first;
+    uint64_t size = std::min(ranges_[i].second, file.size()) -
+        std::min(ranges_[i].first, file.size());
+
+    // sequences on a single line are packed straight from the mapping,
+    // otherwise line breaks (LF or CRLF) are dropped first
+    uint64_t prefix_size = std::min<uint64_t>(size, lengths_[i]);
+    if (size >= lengths_[i] && memchr(data, '\n', prefix_size) == nullptr &&
+        memchr(data, '\r', prefix_size) == nullptr) {
+        return createSequence(names_.name(i), PackedSequence(data,
+            lengths_[i]));
+    }
+
+    thread_local std::string buffer;
+    buffer.clear();
+    for (uint64_t j = 0; j < size && buffer.size() < lengths_[i]; ++j) {
+        if (data[j] != '\n' && data[j] != '\r') {
+            buffer.push_back(data[j]);
+        }
+    }
+    if (buffer.size() != lengths_[i]) {
+        fprintf(stderr, "[rala::SequenceIndex::load] error: "
+            "unable to read sequence %s!\n", names_.name(i).c_str());
+        exit(1);
+    }
+
+    return createSequence(names_.name(i), buffer);
+}
+
+bool SequenceIndex::load_fai(const std::string& path,
+    const std::string& fai_path) {
+
+    struct stat file_stat, fai_stat;
+    if (stat(path.c_str(), &file_stat) != 0 ||
+        stat(fai_path.c_str(), &fai_stat) != 0 ||
+        fai_stat.st_mtime < file_stat.st_mtime) {
+        return false;
+    }
+
+    std::ifstream input(fai_path);
+    if (!input.is_open()) {
+        return false;
+    }
+
+    struct FaiRecord {
+        std::string name;
+        uint64_t length;
+        uint64_t offset;
+        uint64_t line_bases;
+        uint64_t line_width;
+    };
+    std::vector<FaiRecord> records;
+
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        auto name_end = line.find('\t');
+        if (name_end == std::string::npos || name_end + 1 == line.size()) {
+            return false;
+        }
+        FaiRecord record;
+        record.name = line.substr(0, name_end);
+
+        // columns are separated by tabs, line width can end the line
+        const char* column = line.c_str() + name_end;
+        uint64_t* values[4] = { &record.length, &record.offset,
+            &record.line_bases, &record.line_width };
+        for (uint32_t j = 0; j < 4; ++j) {
+            char* column_end = nullptr;
+            *values[j] = strtoull(column + 1, &column_end, 10);
+            if (column_end == column + 1 || (*column_end != '\t' &&
+                (j < 3 || *column_end != '\0'))) {
+                return false;
+            }
+            column = column_end;
+        }
+        if (record.length > UINT32_MAX || (record.length > 0 &&
+            (record.line_bases == 0 || record.line_width < record.line_bases))) {
+            return false;
+        }
+        records.emplace_back(record);
+    }
+
+    for (const auto& it: records) {
+        uint64_t end = it.offset;
+        if (it.length > 0) {
+            end += (it.length / it.line_bases) * it.line_width +
+                it.length % it.line_bases;
+        }
+        add(it.name, it.length, it.offset, end);
+    }
+    is_from_fai_ = true;
+
+    return true;
+}
+
+void SequenceIndex::scan(const std::string& path, bool is_plain,
+    thread_pool::ThreadPool* thread_pool, uint32_t num_threads) {
+
+    // uncompressed files are mapped and scanned in parallel
+    auto file = is_plain ? createMappedFile(path, true) : nullptr;
+    if (file != nullptr) {
+        const char* data = file->data();
+        uint64_t size = file->size();
+
+        uint64_t begin = 0;
+        while (begin < size && data[begin] == '\n') {
+            ++begin;
+        }
+        if (begin == size) {
+            return;
+        }
+        bool is_fastq = isFastq(data[begin], path);
+
+        auto next_line = [&](uint64_t i) -> uint64_t {
+            auto line_end = static_cast<const char*>(memchr(data + i, '\n',
+                size - i));
+            return line_end != nullptr ? line_end - data + 1 : size;
+        };
+        // a FASTQ quality line can begin with '@' as well, but only the name
+        // line is followed by a separator line two lines below
+        auto is_boundary = [&](uint64_t i) -> bool {
+            if (data[i - 1] != '\n' || data[i] != (is_fastq ? '@' : '>')) {
+                return false;
+            }
+            if (!is_fastq) {
+                return true;
+            }
+            uint64_t separator = next_line(next_line(i));
+            return separator < size && data[separator] == '+';
+        };
+
+        auto offsets = file->split(begin, size, num_threads,
+            is_boundary);
+
+        std::vector<std::future<std::vector<Record>>> thread_futures;
+        for (uint32_t i = 0; i + 1 < offsets.size(); ++i) {
+            thread_futures.emplace_back(thread_pool->submit_task(
+                [&](uint64_t part_begin, uint64_t part_end) ->
+                    std::vector<Record> {
+
+                    std::vector<Record> records;
+                    RecordScanner scanner(is_fastq, records);
+                    scanner.feed(data + part_begin, part_end - part_begin,
+                        part_begin);
+                    scanner.finish(part_end);
+                    return records;
+                }, offsets[i], offsets[i + 1]));
+        }
+        for (auto& it: thread_futures) {
+            for (const auto& jt: it.get()) {
+                add(jt.name, jt.length, jt.begin, jt.end);
+            }
+        }
+        return;
+    }
+
+    FILE* input = fopen(path.c_str(), "rb");
+    if (input == nullptr) {
+        fprintf(stderr, "[rala::SequenceIndex::scan] error: "
+            "unable to open file %s!\n", path.c_str());
+        exit(1);
+    }
+
+    std::vector<char> buffer(kScanBufferSize);
+    std::vector<Record> records;
+    std::unique_ptr<RecordScanner> scanner;
+
+    uint64_t position = 0; // of the first byte in buffer
+    for (uint64_t num_bytes = 0;; position += num_bytes) {
+        num_bytes = fread(buffer.data(), 1, buffer.size(), input);
+        if (num_bytes == 0) {
+            break;
+        }
+        if (scanner == nullptr) {
+            auto first = std::find_if(buffer.begin(), buffer.begin() +
+                num_bytes, [](char c) -> bool { return c != '\n'; });
+            if (first == buffer.begin() + num_bytes) {
+                continue;
+            }
+            scanner.reset(new RecordScanner(isFastq(*first, path), records));
+        }
+
+        scanner->feed(buffer.data(), num_bytes, position);
+        for (const auto& it: records) {
+            add(it.name, it.length, it.begin, it.end);
+        }
+        records.clear();
+    }
+    if (scanner != nullptr) {
+        scanner->finish(position);
+        for (const auto& it: records) {
+            add(it.name, it.length, it.begin, it.end);
+        }
+    }
+
+    fclose(input);
+}
+
+}
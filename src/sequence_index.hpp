@@ -0,0 +1,110 @@
+/*!
+ * @file sequence_index.hpp
+ *
+ * @brief SequenceIndex class header file
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "name_table.hpp"
+
+namespace thread_pool {
+    class ThreadPool;
+}
+
+namespace rala {
+
+class InputFile;
+class MappedFile;
+class Sequence;
+
+class SequenceIndex;
+std::unique_ptr<SequenceIndex> createSequenceIndex(const std::string& path,
+    InputFile* file, thread_pool::ThreadPool* thread_pool,
+    uint32_t num_threads);
+
+/*!
+ * @brief Names (up to the first whitespace) and lengths of all sequences of
+ * a FASTA/FASTQ file, in file order; they are read from a samtools index
+ * (path.fai) if there is an up to date one, otherwise the file is scanned
+ * once without storing any bases (sequence lines are only counted,
+ * uncompressed files are memory-mapped and split at record boundaries into
+ * parts scanned in parallel); for uncompressed files byte ranges of sequence
+ * lines are recorded as well so that single sequences can be read later on
+ * without parsing the whole file
+ */
+class SequenceIndex {
+public:
+    ~SequenceIndex() = default;
+
+    uint64_t size() const {
+        return lengths_.size();
+    }
+
+    uint32_t length(uint64_t i) const {
+        return lengths_[i];
+    }
+
+    const NameTable& names() const {
+        return names_;
+    }
+
+    /*!
+     * @brief Returns true if sequences can be read with load()
+     */
+    bool has_ranges() const {
+        return ranges_.size() == lengths_.size();
+    }
+
+    /*!
+     * @brief Creates the i-th sequence from the mapping of the indexed file
+     * (bases are packed without intermediate copies if the sequence is on a
+     * single line); thread safe
+     */
+    std::unique_ptr<Sequence> load(const MappedFile& file, uint64_t i) const;
+
+    /*!
+     * @brief Returns true if names and lengths were taken from path.fai
+     */
+    bool is_from_fai() const {
+        return is_from_fai_;
+    }
+
+    friend std::unique_ptr<SequenceIndex> createSequenceIndex(
+        const std::string& path, InputFile* file,
+        thread_pool::ThreadPool* thread_pool, uint32_t num_threads);
+private:
+    SequenceIndex();
+    SequenceIndex(const SequenceIndex&) = delete;
+    const SequenceIndex& operator=(const SequenceIndex&) = delete;
+
+    /*!
+     * @brief Loads names, lengths and sequence ranges (from offset, line
+     * bases and line width columns) from fai_path; returns false if the index
+     * is missing, older than path or malformed
+     */
+    bool load_fai(const std::string& path, const std::string& fai_path);
+
+    /*!
+     * @brief Reads records from path (FASTA or FASTQ, detected from the first
+     * record) keeping only names, lengths and sequence ranges
+     */
+    void scan(const std::string& path, bool is_plain,
+        thread_pool::ThreadPool* thread_pool, uint32_t num_threads);
+
+    void add(const std::string& name, uint32_t length, uint64_t begin,
+        uint64_t end);
+
+    NameTable names_;
+    std::vector<uint32_t> lengths_;
+    // bytes [first, second> of the file hold the sequence (and line breaks)
+    std::vector<std::pair<uint64_t, uint64_t>> ranges_;
+    bool is_from_fai_;
+};
+
+}
@@ -0,0 +1,441 @@
+/*!
+ * @file rala_test.cpp
+ *
+ * @brief Regression tests which assemble a synthetic dataset (data/) in
+ * different configurations and compare contigs with the output of the
+ * original implementation (data/contigs.fasta)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+
+#include "graph.hpp"
+#include "input_file.hpp"
+#include "output_file.hpp"
+#include "packed_sequence.hpp"
+#include "sequence_index.hpp"
+
+#include "thread_pool/thread_pool.hpp"
+
+std::string data_path;
+std::string work_path;
+std::vector<std::string> work_files;
+
+/*!
+ * @brief Returns the path of a file in the working directory, which is
+ * removed once all tests finish
+ */
+std::string workFile(const std::string& name) {
+    auto path = work_path + "/" + name;
+    if (std::find(work_files.begin(), work_files.end(), path) ==
+        work_files.end()) {
+        work_files.emplace_back(path);
+    }
+    return path;
+}
+
+std::string readFile(const std::string& path) {
+
+    gzFile input = gzopen(path.c_str(), "rb"); // reads plain files as well
+    if (input == nullptr) {
+        fprintf(stderr, "[rala_test::readFile] error: "
+            "unable to open file %s!\n", path.c_str());
+        exit(1);
+    }
+
+    std::string dst;
+    char buffer[65536];
+    int num_bytes;
+    while ((num_bytes = gzread(input, buffer, sizeof(buffer))) > 0) {
+        dst.append(buffer, num_bytes);
+    }
+    gzclose(input);
+
+    return dst;
+}
+
+void writeFile(const std::string& path, const std::string& data,
+    rala::Compression compression = rala::Compression::kNone) {
+
+    auto output = rala::createOutputFile(path, compression, 2);
+    output->write(data);
+    output->close();
+}
+
+/*!
+ * @brief Returns the data which parsers see in a pass over path
+ */
+std::string readPass(const std::string& path) {
+
+    auto thread_pool = thread_pool::createThreadPool(3);
+    auto file = rala::createInputFile(path, thread_pool.get(), 3);
+    file->rewind();
+
+    FILE* input = fopen(file->path().c_str(), "rb");
+    if (input == nullptr) {
+        fprintf(stderr, "[rala_test::readPass] error: "
+            "unable to open file %s!\n", file->path().c_str());
+        exit(1);
+    }
+
+    std::string dst;
+    char buffer[65536];
+    uint64_t num_bytes;
+    while ((num_bytes = fread(buffer, 1, sizeof(buffer), input)) > 0) {
+        dst.append(buffer, num_bytes);
+    }
+    fclose(input);
+
+    return dst;
+}
+
+/*!
+ * @brief Returns true if the index of path holds names of all records (up to
+ * the first whitespace) and if it was read from path.fai when expected
+ */
+bool checkIndex(const std::string& path, const std::string& data,
+    bool is_from_fai) {
+
+    auto thread_pool = thread_pool::createThreadPool(3);
+    auto file = rala::createInputFile(path, thread_pool.get(), 3);
+    auto index = rala::createSequenceIndex(path, file.get(), thread_pool.get(),
+        3);
+
+    uint64_t num_records = 0;
+    for (uint64_t i = 0; (i = data.find('>', i)) != std::string::npos; ++i) {
+        auto name = data.substr(i + 1, data.find_first_of(" \t\r\n", i) -
+            i - 1);
+        if (num_records >= index->size() ||
+            index->names().name(num_records) != name) {
+            return false;
+        }
+        ++num_records;
+    }
+
+    return num_records == index->size() && index->is_from_fai() == is_from_fai;
+}
+
+bool fileExists(const std::string& path) {
+    return access(path.c_str(), F_OK) == 0;
+}
+
+/*!
+ * @brief Builds a samtools index of a FASTA file whose records have lines of
+ * equal width (names end at the first whitespace)
+ */
+std::string faiIndex(const std::string& data) {
+
+    std::string dst;
+    uint64_t i = 0;
+    while (i < data.size()) {
+        uint64_t name_end = data.find('\n', i);
+        std::string name = data.substr(i + 1, name_end - i - 1);
+        name = name.substr(0, name.find_first_of(" \t\r"));
+
+        uint64_t offset = name_end + 1, length = 0, line_bases = 0,
+            line_width = 0;
+        for (i = offset; i < data.size() && data[i] != '>';) {
+            uint64_t line_end = data.find('\n', i);
+            uint64_t line_length = line_end - i;
+            if (line_length > 0 && data[line_end - 1] == '\r') {
+                --line_length;
+            }
+            if (line_width == 0) {
+                line_bases = line_length;
+                line_width = line_end + 1 - i;
+            }
+            length += line_length;
+            i = line_end + 1;
+        }
+
+        dst += name + "\t" + std::to_string(length) + "\t" +
+            std::to_string(offset) + "\t" + std::to_string(line_bases) + "\t" +
+            std::to_string(line_width) + "\n";
+    }
+
+    return dst;
+}
+
+/*!
+ * @brief Returns the reverse complement of data in which only A, C, G and T
+ * are complemented (as rala::PackedSequence does)
+ */
+std::string reverseComplement(const std::string& data) {
+    std::string dst(data.rbegin(), data.rend());
+    for (auto& it: dst) {
+        switch (it) {
+            case 'A': it = 'T'; break;
+            case 'C': it = 'G'; break;
+            case 'G': it = 'C'; break;
+            case 'T': it = 'A'; break;
+            default: break;
+        }
+    }
+    return dst;
+}
+
+/*!
+ * @brief Runs the whole pipeline and returns contigs in FASTA format (written
+ * to contigs_path which has to be distinct for concurrent runs)
+ */
+std::string assemble(const std::string& sequences_path,
+    const std::string& overlaps_path, uint32_t num_threads,
+    uint64_t max_store_size = 1ULL << 30, bool use_overlap_cache = false,
+    bool compress_piles = false,
+    const std::string& contigs_path = workFile("contigs.fasta")) {
+
+    auto graph = rala::createGraph(sequences_path, overlaps_path, "", -1,
+        num_threads, max_store_size, use_overlap_cache, compress_piles);
+    graph->construct();
+    graph->simplify("");
+
+    auto output = rala::createOutputFile(contigs_path, rala::Compression::kNone,
+        1);
+    graph->write_contigs(output.get());
+    output->close();
+
+    return readFile(contigs_path);
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: rala_test <data directory>\n");
+        return 1;
+    }
+    data_path = argv[1];
+
+    char work_template[] = "rala_test.XXXXXX";
+    if (mkdtemp(work_template) == nullptr) {
+        fprintf(stderr, "[rala_test] error: "
+            "unable to create working directory!\n");
+        return 1;
+    }
+    work_path = work_template;
+
+    auto expected = readFile(data_path + "/contigs.fasta");
+    auto sequences = readFile(data_path + "/reads.fasta.gz");
+    auto overlaps = readFile(data_path + "/overlaps.paf.gz");
+
+    auto sequences_path = workFile("reads.fasta");
+    auto overlaps_path = workFile("overlaps.paf");
+    writeFile(sequences_path, sequences);
+    writeFile(overlaps_path, overlaps);
+
+    std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+        {"packed sequences", [&]() -> bool {
+            // runs of soft-masked bases, Ns and other characters
+            const std::string alphabet[] = { "ACGT", "acgt", "N", "n", "RYK" };
+            std::string data;
+            srand(7);
+            while (data.size() < 5000) {
+                const auto& it = alphabet[rand() % 5];
+                for (uint32_t i = 0, j = rand() % 70 + 1; i < j; ++i) {
+                    data += it[rand() % it.size()];
+                }
+            }
+            std::string reverse = reverseComplement(data);
+
+            rala::PackedSequence packed(data);
+            if (packed.to_string() != data || packed.to_string(true) !=
+                reverse) {
+                return false;
+            }
+            for (uint32_t i = 0; i < data.size(); ++i) {
+                if (packed.at(i) != data[i] || packed.at(i, true) !=
+                    reverse[i]) {
+                    return false;
+                }
+            }
+
+            rala::PackedSequence appended;
+            std::string expected_appended;
+            for (uint32_t i = 0; i < 200; ++i) {
+                uint32_t begin = rand() % data.size();
+                uint32_t length = rand() % (data.size() - begin + 1);
+                bool is_reverse_complement = rand() % 2;
+                const auto& src = is_reverse_complement ? reverse : data;
+
+                std::string decoded;
+                packed.decode(begin, length, is_reverse_complement, decoded);
+                if (decoded != src.substr(begin, length)) {
+                    return false;
+                }
+                appended.append(packed, begin, length, is_reverse_complement);
+                expected_appended += src.substr(begin, length);
+            }
+            appended.trim(1000, appended.size() - 1000);
+
+            return appended.to_string() == expected_appended.substr(1000,
+                expected_appended.size() - 2000);
+        }},
+        {"single thread", [&]() -> bool {
+            return assemble(sequences_path, overlaps_path, 1) == expected;
+        }},
+        {"multiple threads", [&]() -> bool {
+            return assemble(sequences_path, overlaps_path, 8) == expected;
+        }},
+        {"low memory piles", [&]() -> bool {
+            return assemble(sequences_path, overlaps_path, 3, 1ULL << 30,
+                false, true) == expected;
+        }},
+        {"without overlap store", [&]() -> bool {
+            return assemble(sequences_path, overlaps_path, 3, 0) == expected;
+        }},
+        {"overlap cache rerun", [&]() -> bool {
+            auto path = workFile("cached.paf");
+            workFile("cached.paf.rala");
+            writeFile(path, overlaps);
+            return assemble(sequences_path, path, 2, 0, true) == expected &&
+                fileExists(path + ".rala") &&
+                assemble(sequences_path, path, 2, 0, true) == expected;
+        }},
+        {"overlap cache of a file rewritten in place", [&]() -> bool {
+            auto path = workFile("rewritten.paf");
+            workFile("rewritten.paf.rala");
+            writeFile(path, overlaps);
+            assemble(sequences_path, path, 2, 0, true);
+
+            // same size and time stamps, different strands
+            struct stat file_stat;
+            stat(path.c_str(), &file_stat);
+            std::string data = overlaps;
+            for (auto& it: data) {
+                it = it == '+' ? '-' : (it == '-' ? '+' : it);
+            }
+            writeFile(path, data);
+            struct timespec times[2] = { file_stat.st_atim, file_stat.st_mtim };
+            utimensat(AT_FDCWD, path.c_str(), times, 0);
+
+            auto contigs = assemble(sequences_path, path, 2, 0, false);
+            return contigs != expected &&
+                assemble(sequences_path, path, 2, 0, true) == contigs;
+        }},
+        {"gzip inputs", [&]() -> bool {
+            return assemble(data_path + "/reads.fasta.gz",
+                data_path + "/overlaps.paf.gz", 4) == expected;
+        }},
+        {"bgzf inputs", [&]() -> bool {
+            auto reads_path = workFile("reads.bgzf.fasta.gz");
+            auto paf_path = workFile("overlaps.bgzf.paf.gz");
+            writeFile(reads_path, sequences, rala::Compression::kBgzf);
+            writeFile(paf_path, overlaps, rala::Compression::kBgzf);
+            return assemble(reads_path, paf_path, 4) == expected;
+        }},
+        {"bgzf blocks filling whole batches", [&]() -> bool {
+            // 64 blocks of data are inflated in one batch, the end-of-file
+            // marker block in the next one
+            std::string data;
+            for (uint32_t i = 0; data.size() < 64 * 0xff00; ++i) {
+                data.push_back(sequences[i % sequences.size()]);
+            }
+            auto path = workFile("batches.fasta.gz");
+            writeFile(path, data, rala::Compression::kBgzf);
+            return readPass(path) == data;
+        }},
+        {"empty bgzf file", [&]() -> bool {
+            auto path = workFile("empty.fasta.gz");
+            writeFile(path, "", rala::Compression::kBgzf);
+            return readPass(path).empty();
+        }},
+        {"samtools index", [&]() -> bool {
+            auto path = workFile("indexed.fasta");
+            writeFile(path, sequences);
+            writeFile(workFile("indexed.fasta.fai"), faiIndex(sequences));
+            return assemble(path, overlaps_path, 1) == expected &&
+                assemble(path, overlaps_path, 4) == expected;
+        }},
+        {"headers with descriptions", [&]() -> bool {
+            std::string data;
+            for (uint64_t i = 0; i < sequences.size(); ++i) {
+                if (sequences[i] == '\n' && data.find('>',
+                    data.rfind('\n') + 1) != std::string::npos) {
+                    data += " some description\tof the read";
+                }
+                data.push_back(sequences[i]);
+            }
+            auto path = workFile("described.fasta");
+            auto gzip_path = workFile("described.fasta.gz");
+            writeFile(path, data);
+            writeFile(gzip_path, data, rala::Compression::kGzip);
+
+            bool is_passed = checkIndex(path, data, false) &&
+                assemble(path, overlaps_path, 2) == expected &&
+                assemble(gzip_path, overlaps_path, 2) == expected;
+
+            writeFile(workFile("described.fasta.fai"), faiIndex(data));
+            return is_passed && checkIndex(path, data, true) &&
+                assemble(path, overlaps_path, 2) == expected;
+        }},
+        {"crlf line breaks", [&]() -> bool {
+            std::string data;
+            for (const auto& it: sequences) {
+                if (it == '\n') {
+                    data.push_back('\r');
+                }
+                data.push_back(it);
+            }
+            auto path = workFile("crlf.fasta");
+            writeFile(path, data);
+
+            bool is_passed = assemble(path, overlaps_path, 2) == expected;
+
+            writeFile(workFile("crlf.fasta.fai"), faiIndex(data));
+            return is_passed && checkIndex(path, data, true) &&
+                assemble(path, overlaps_path, 2) == expected;
+        }},
+        {"concurrent graphs", [&]() -> bool {
+            // records in reverse order get different ids
+            std::string data;
+            for (uint64_t end = sequences.size(); end > 0;) {
+                uint64_t begin = sequences.rfind('>', end - 1);
+                data += sequences.substr(begin, end - begin);
+                end = begin;
+            }
+            auto path = workFile("reversed.fasta");
+            writeFile(path, data);
+            auto reversed = assemble(path, overlaps_path, 2);
+
+            std::string contigs[2];
+            auto contigs_path = workFile("concurrent.fasta");
+            auto reversed_contigs_path = workFile("reversed_concurrent.fasta");
+            std::thread thread([&]() -> void {
+                contigs[0] = assemble(sequences_path, overlaps_path, 2, 0,
+                    false, false, contigs_path);
+            });
+            contigs[1] = assemble(path, overlaps_path, 2, 0, false, false,
+                reversed_contigs_path);
+            thread.join();
+
+            return contigs[0] == expected && contigs[1] == reversed;
+        }},
+    };
+
+    uint32_t num_failed = 0;
+    for (const auto& it: tests) {
+        bool is_passed = it.second();
+        fprintf(stderr, "[rala_test] %s: %s\n", it.first.c_str(),
+            is_passed ? "passed" : "FAILED");
+        num_failed += !is_passed;
+    }
+
+    for (const auto& it: work_files) {
+        remove(it.c_str());
+    }
+    rmdir(work_path.c_str());
+
+    fprintf(stderr, "[rala_test] %u of %zu tests failed\n", num_failed,
+        tests.size());
+
+    return num_failed == 0 ? 0 : 1;
+}